@@ -43,6 +43,9 @@ Add direct conversion receiver oscillator mode select
 #include <SPI.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_PCD8544.h>
+#include "Skinny_PCD8544.h"
+#include "Skinny_ADC.h"
+#include "Skinny_EEPROM.h"
 #include <toneAC.h>
 #include <EEPROM.h>
 #include <avr/pgmspace.h>
@@ -50,6 +53,14 @@ Add direct conversion receiver oscillator mode select
 #include "VE3OOI_Si5351_v1.3.h"         // VE3OOI Si5351 Routines
 #include "LBS_VE3OOI_V1.3.h"
 #include "Skinny_UART.h"
+#include "Skinny_CAT.h"
+#include "Skinny_TX.h"
+#include "Skinny_Scan.h"
+#include "Skinny_Scope.h"
+#include "Skinny_Encoder.h"
+#include "Skinny_Mem.h"
+#include "Skinny_Prof.h"
+#include "Skinny_Sched.h"
 
 // If UPDATE_EEPROM is defined then, messages are storeded in EEPROM and the "L" command is used to copy text into EEPROM one
 // line at a time.  If UPDATE_EEPROM is NOT defined, then messages stored in Program Memory is used for messages.
@@ -62,6 +73,7 @@ extern unsigned long numbers[MAX_COMMAND_ENTRIES];
 
 // This defines the various variables (See Silicon Labs AN619 Note)
 extern Si5351_def multisynth;
+extern Si5351_stats_def si5351stats;
 
 #define NOTE_B5      988
 #define TUNE_VOLUME  5         // Speaker volume setting
@@ -105,8 +117,8 @@ New Values for VE3OOI PCB Board
 // pin D4 - LCD reset (RST)
 */
 
-//----Adafruit_PCD8544 display = Adafruit_PCD8544(8, 7, 6, 4, 5);  // Original PARC Design
-Adafruit_PCD8544 display = Adafruit_PCD8544(8, 7, 6, 5, 4); // VE3OOI design
+//----Skinny_PCD8544 display = Skinny_PCD8544(8, 7, 6, 4, 5);  // Original PARC Design
+Skinny_PCD8544 display = Skinny_PCD8544(8, 7, 6, 5, 4); // VE3OOI design.  Only changed parts of the screen are sent on flush()
 
 const int Backlight = 9; // Analog output pin that the LED is attached to
 static const unsigned char PROGMEM logo16_glcd_bmp[] =
@@ -139,23 +151,44 @@ const char helpmsg[] PROGMEM = {
   "C is use for Calibration\r\n"
   " C - Display all saved calibration parameters\r\n"
   " CW - Manual write calibration parameters to EEPROM\r\n"
-  " CS n f - Enter Si5351 calibration value n and set freq to f in Hz\r\n"
-  "   Eg: CS 60 10000000 - this sets Si Calibration to 60 and frequecy set to 10 MHz\r\n"
+  " CS n f - Enter Si5351 calibration value n in parts per billion and set freq to f in Hz\r\n"
+  "   Eg: CS 6000 10000000 - this sets Si Calibration to 6000 (6 ppm) and frequecy set to 10 MHz\r\n"
+  "   Eg: CS -6000 10000000 - negative calibration for a crystal running slow\r\n"
   " CM n - Calibrate Smeter to S level n. Only supports S9 to S5\r\n"
   "   Eg: CM 9 - this expects a S9 signal source connnect to antenna and calibrates SMeter\r\n"
   " CMO n - Enter Smeter offset n between 100 to 150\r\n"
   "   Eg: CMO 115 - this shifts the Smeter display by 115\r\n"
   " CMD n - Enter Smeter delay or sensitivity n between 0 to 20\r\n"
   "   Eg: CMD 1 - this causes the display to pause by 1 unit before updating\r\n"
+  " CMA n - Enter Smeter attack n between 0 to 15 (time is 2^n / 9600 sec)\r\n"
+  " CMR n - Enter Smeter release (decay) n between 0 to 15\r\n"
+  "   Eg: CMA 6 and CMR 12 - 7 ms attack and 430 ms decay\r\n"
   "D - Display all saved parameters\r\n"
-  "R - Reset LBS software\r\n"};
+  "E - Display encoder queue statistics\r\n"
+  " ER - Reset encoder queue statistics\r\n"
+  "S - Display scanner state and channels per second\r\n"
+  " SR a b s - Scan from a to b Hz in steps of s Hz (0 for the tuning step)\r\n"
+  " SC - Scan the memory channels\r\n"
+  " SS - Stop scanning.  Turning the knob or pressing it also stops\r\n"
+  " SW n f - Store f Hz in memory channel n (0 to 15), f 0 clears.  SL lists them\r\n"
+  " SP t h l - Settle t ms, hang h ms and squelch level l (S meter pixels, 0 to 68)\r\n"
+  "B n - Bandscope of n Hz around the dial frequency (0 for 25 kHz)\r\n"
+  " BS - Back to the normal screen.  BI - Display sweeps per second\r\n"
+  "M - Display free RAM, least free RAM, stack high water mark and heap in bytes\r\n"
+  " MR - Reset the high water marks\r\n"
+  "P - Display main loop stage timing.  PR - Reset it\r\n"
+  "T - Display scheduler tasks, overruns and worst case time.  TR - Reset it\r\n"
+  "I - Display Si5351 I2C write statistics\r\n"
+  " IR - Reset Si5351 I2C write statistics\r\n"
+  "R - Reset LBS software\r\n"
+  "\r\nKenwood TS-480 CAT commands (FA MD SM ST IF ID) ending with ; are also accepted, e.g. FA; or MD2;\r\n"};
   
 const char guidemsg[] PROGMEM = {
   "Si5351 Calibration Guide\r\n"
   "1) Connect Frequency counter to any Si5351 Clock output\r\n"
-  "2) Enter 'CS 100 10000000' to set Calibration to 100 for 10000000 Hz. Verify Clock output accuracy\r\n"
-  "3) Reenter CS command with change calibration value to adjust frequency\r\n"
-  "   Eg: CS 90 10000000, lowers calibration value from 100\r\n"
+  "2) Enter 'CS 10000 10000000' to set Calibration to 10000 ppb for 10000000 Hz. Verify Clock output accuracy\r\n"
+  "3) Reenter CS command with change calibration value to adjust frequency. 100 ppb is 1 Hz at 10 MHz\r\n"
+  "   Eg: CS 9000 10000000, lowers calibration value from 10000\r\n"
   "4) Enter R to reset back to normal LBS Radio mode.  Alternatively power off/on arduino\r\n"
   "\r\nSmeter Calibration Guide\r\n"
   "1) Connect S5 to S9 signal source to antenna\r\n"
@@ -183,28 +216,49 @@ int_fast32_t bfo2 = 0;         // Prior frequency of BFO
 int_fast32_t bfo = 4913700L;
 int_fast32_t DC_RX_Freq = rx - bfo; // initial value for direct conversion receive frequency
 
-String hertz = " 100";
-byte ones, tens, hundreds, thousands, tenthousands, hundredthousands, millions ; //Placeholders
+// Steps and their labels live in flash.  stepidx selects the one in use
+const tune_step_def tunesteps[TUNE_STEPS] PROGMEM = {
+  {10, " 10"}, {100, "100"}, {1000, " 1K"}, {10000, "10K"}, {100000, "1xK"}, {1000000, " 1M"}};
+unsigned char stepidx = TUNE_STEP_DEFAULT;
 
 unsigned char DC_RX_mode = 0;  // High = direct conversion on CLK0 is enabled
 
 unsigned char LSB_Mode = 1;
+unsigned char lastLSB_Mode = 0xFF;    // Forces the mode to be drawn on the first pass
+unsigned char lastLSB_Switch = 0xFF;  // LSB_BTN last read.  The switch sets the mode when it moves, CAT (MD) in between
 
-unsigned char  EncButtonState = 0;
+unsigned char  EncButtonState = 0;     // Encoder button held
+unsigned long  buttontime;              // millis() of the last step change by the encoder button
 unsigned char  TuneButtonState = 0;
 unsigned char  lastButtonState = 0;
 
 lbs_struture lbsmem;
 unsigned long timeLapse;
-unsigned long flags;
+unsigned char flags;
 unsigned int SmeterDelay;
-double uvLevel;
-
-Rotary EncoderInput = Rotary(ENCODER_B, ENCODER_A); // sets the pins the rotary encoder uses.  Must be interrupt pins.
+unsigned char uvLevel;          // S meter calibration factor while CALIBRATE_SMETER is set
+unsigned int uvLevelLog;        // Log20(lbsmem.uVLevel) cached by SmeterReference()
+unsigned char smeter;           // S meter bar length in pixels last measured
+unsigned char renderflags;      // RENDER_xxx parts of the screen waiting to be drawn
+unsigned long frametime;        // millis() of the last frame drawn
+unsigned int retuneus;          // Time the last retune took in us (SetFrequency() calls)
+
+RotaryFast<ENCODER_B, ENCODER_A> EncoderInput; // sets the pins the rotary encoder uses.  Must be interrupt pins on the same port.
+
+// loop() work in priority order (see Skinny_Sched.h).  Period in ms (0 polls every pass) and budget in us
+const Skinny_Task_def tasks[] PROGMEM = {
+  {TaskSerial,  0,                   1000, PROF_SERIAL},
+  {TaskSweep,   0,                   1000, PROF_SWEEP},
+  {TaskTune,    0,                   1500, PROF_TUNE},
+  {TaskRender,  0,                   4000, PROF_RENDER},
+  {TaskSmeter,  TASK_SMETER_PERIOD,  500,  PROF_SMETER},
+  {TaskButtons, TASK_BUTTON_PERIOD,  500,  PROF_BUTTONS},
+  {TaskSave,    EEPROM_WRITE_TIME,   1000, PROF_SAVE}};
 
 void setup() {
 
-  Serial.begin(9600); // connect to the serial port
+  MemInit ();                // Paint the free RAM for the stack high water mark (M command)
+  Serial.begin(SERIAL_BAUD); // connect to the serial port
 
   PCICR |= (1 << PCIE2);
   PCMSK2 |= (1 << PCINT18) | (1 << PCINT19);
@@ -226,12 +280,18 @@ void setup() {
 
   pinMode(XMIT_ON, OUTPUT);
 
+  // S meter sampling runs in the background from here on
+  AdcStart (SENSOR, SMETER_PRESCALER, SMETER_DECIMATE);
+
   ResetLBS (); 
+  SchedInit (tasks, sizeof(tasks) / sizeof(tasks[0]));
 }
 
 
 void ResetLBS (void) 
 {
+  // Finish queued EEPROM writes (e.g. from CW) before the radio restarts
+  EEFlush ();
   LSBbfoFreq = LSB_BFO_FREQ;
   USBbfoFreq = USB_BFO_FREQ;
   timeLapse = millis();
@@ -244,15 +304,15 @@ void ResetLBS (void)
   // set backlight & contrast level
   analogWrite(Backlight, BACK_LIGHT);
   display.setContrast(CONTRAST);
-  // show splashscreen
-  display.display(); 
+  // show splashscreen.  begin() resets the controller so the whole buffer must be sent
+  display.invalidate();
+  display.flush(); 
   delay(250);
   
   // clears the screen and display initial screen
   display.clearDisplay();   
   setupScreen ();
-  showFreq();
-  showMode();
+  renderflags = RENDER_FREQ | RENDER_MODE | RENDER_SMETER;
 
   // Read saved setting to overwrite defaults
   ReadSettings (); 
@@ -272,7 +332,7 @@ void ResetLBS (void)
   // Reset TTY
   ResetSerial ();
 #ifdef UPDATE_EEPROM  
-  Serial.println ("PARC LBS Build (VE3OOI) V1.2.3a");
+  TxFlash (PSTR ("PARC LBS Build (VE3OOI) V1.2.3a\r\n"));
 #else      
   pgmMessage (bannermsg);
 #endif
@@ -283,51 +343,110 @@ void ResetLBS (void)
 
 
 ISR(PCINT2_vect) {
+  // Only queue the step here.  rx is 32 bits and changing it in the ISR could give loop() a torn value
+  PROF_VAR (pt);
+  PROF_BEGIN (pt);
   unsigned char result = EncoderInput.process();
 
-  if (result) {
-    if (result == DIR_CW) {
-      rx += increment;
-    } else if (result == DIR_CCW){
-      rx -= increment;
-    };
+  if (result == DIR_CW) {
+    EncoderPush (1);
+    PROF_DETENT_MARK ();
+  } else if (result == DIR_CCW) {
+    EncoderPush (-1);
+    PROF_DETENT_MARK ();
+  }
+  PROF_STAGE (pt, PROF_ISR);
+}
 
-    if (rx >= 12216700) {
-      rx = rx2;
-    }; // UPPER VFO LIMIT
-    if (rx <= 11913700) {
-      rx = rx2;
-    }; // LOWER VFO LIMIT
+void ApplyEncoderSteps (int steps)
+// Moves rx by steps x increment.  Steps that would go past the VFO limits are dropped so rx stops at the last valid value
+{
+  long room;
+
+  if (steps > 0) {
+    room = (RX_UPPER_LIMIT - 1 - rx) / increment;
+    if (room < 0) room = 0;
+    if (steps > room) steps = room;
+  } else if (steps < 0) {
+    room = (RX_LOWER_LIMIT + 1 - rx) / increment;
+    if (room > 0) room = 0;
+    if (steps < room) steps = room;
   }
+  rx += (long)steps * increment;
 }
 
 
 void loop ()
 {
-
+  PROF_VAR (pass);                    // Profiler, see Skinny_Prof.h
 
   while (flags & CALIBRATE_SI5351 || flags & CALIBRATE_SMETER) {
     ProcessSerial ();
+    TxPump ();
     
+    // The ADC samples in the background so this loop never waits for it and the console stays responsive
     if (flags & CALIBRATE_SMETER) {
-      SmeterDelay = peakDetect (PKDETECT_SAMPLES);
-      lbsmem.uVLevel = SmeterDelay*uvLevel;
-      showSmeter ();
-      delay(100);
+      readSmeter ();
+      RenderScreen ();
     }    
   }
 
+  PROF_BEGIN (pass);
+  SchedRun ();
+  PROF_STAGE (pass, PROF_LOOP);
+}
+
+void TaskSerial (void)
+// Console and CAT.  Both return straight away when there is nothing to read or send
+{
   ProcessSerial ();
-  
-  if (SmeterDelay++ > lbsmem.uVDelay) {
-    showSmeter();
-    SmeterDelay = 0;
+  TxPump ();
+}
+
+void TaskSweep (void)
+// Scanner or bandscope, whichever is running
+{
+  unsigned long freq;
+  unsigned int level;
+  unsigned char x;
+
+  // The scanner takes the ADC windows while it runs and the S meter shows what it measured
+  if (ScanActive ()) {
+    freq = ScanTask (RX_LOWER_LIMIT - bfo, RX_UPPER_LIMIT - bfo);
+    if (freq) rx = freq + bfo;
+    if (ScanLevel () != smeter) {
+      smeter = ScanLevel ();
+      renderflags |= RENDER_SMETER;
+    }
+  } else if (ScopeActive ()) {
+    // CLK0 is swept here directly so rx (the dial) stays put.  In direct conversion CLK0 is the dial + bfo
+    freq = ScopeTask ();
+    if (freq) SetFrequency (SI_CLK0, SI_PLL_A, DC_RX_mode ? freq + bfo : freq, SI_CLK_8MA);
+    if (ScopeReady (&x, &level)) showScopePoint (x, level);
   }
+}
+
+void TaskTune (void)
+// Encoder steps, the LSB/USB switch and the retune when rx or the BFO moved.  Nothing to do most passes
+{
+  int steps;
+  unsigned long t;
+  PROF_VAR (detent);
 
-  checkMode(); 
+  // Apply all the encoder steps queued by the ISR since the last pass.  Turning the knob stops the scanner
+  PROF_DETENT_TAKE (detent);
+  steps = EncoderDrain ();
+  if (steps) ScanStop ();
+  ApplyEncoderSteps (steps);
 
   //If LSB_BTN is true do the following.
-  LSB_Mode = digitalRead(LSB_BTN);
+  if (digitalRead(LSB_BTN) != lastLSB_Switch) {
+    lastLSB_Switch = LSB_Mode = digitalRead(LSB_BTN);
+  }
+  if (LSB_Mode != lastLSB_Mode) {
+    lastLSB_Mode = LSB_Mode;
+    renderflags |= RENDER_MODE;
+  }
   if (LSB_Mode) { 
     bfo = LSBbfoFreq;
   } else {               //Otherwise use USB
@@ -336,11 +455,13 @@ void loop ()
   if (bfo2 != bfo) {
     bfo2 = bfo;
     SetFrequency (SI_CLK2, SI_PLL_B, (unsigned long int)bfo, SI_CLK_8MA);
+    renderflags |= RENDER_FREQ;       // The displayed frequency is rx - bfo
   }
 
   if  (rx != rx2) {
-    showFreq();
-
+    renderflags |= RENDER_FREQ;
+    MEM_SITE_BEGIN ();
+    t = micros ();
 
     if (!DC_RX_mode) {
       DC_RX_Freq = rx - bfo;
@@ -349,52 +470,77 @@ void loop ()
       SetFrequency (SI_CLK0, SI_PLL_A, (unsigned long int)rx, SI_CLK_8MA);
       SetFrequency (SI_CLK2, SI_PLL_B, (unsigned long int)bfo, SI_CLK_8MA);
     }
+    retuneus = micros () - t;
+    MEM_SITE_END (MEM_SITE_TUNE);
+    PROF_DETENT_DONE (detent);
+    if (ScopeActive ()) ScopeStart (rx - bfo, ScopeSpan ());     // Knob moves the bandscope centre
 
     rx2 = rx;
       
     lbsmem.rx = rx;
     lbsmem.bfo = bfo;
     lbsmem.increment = increment;
-    hertz.toCharArray(lbsmem.hertz, sizeof(lbsmem.hertz)) ;
+    StepLabel (lbsmem.hertz);
     flags |= UPDATE;    
   }
+}
 
-  EncButtonState = digitalRead(ENCODER_BTN);
-  if (EncButtonState == LOW) {
-    setincrement();
-    delay(200);
-    showFreq();
-     
-    lbsmem.rx = rx;
-    lbsmem.bfo = bfo;
-    lbsmem.increment = increment;
-    hertz.toCharArray(lbsmem.hertz, sizeof(lbsmem.hertz)) ;
-    flags |= UPDATE;
+void TaskSmeter (void)
+// The scanner and bandscope use the ADC while they run.  CMD n slows the meter down by n periods
+{
+  if (ScanActive () || ScopeActive ()) return;
+  if (SmeterDelay++ < lbsmem.uVDelay) return;
+  SmeterDelay = 0;
+  readSmeter ();
+}
+
+void TaskButtons (void)
+// Tune button and encoder button.  Polling every TASK_BUTTON_PERIOD ms is the debounce.
+// Holding the encoder button steps through the increments every BUTTON_REPEAT ms
+{
+  checkMode ();
+
+  if (digitalRead(ENCODER_BTN) != LOW) {
+    EncButtonState = 0;
+    return;
   }
+  if (EncButtonState && millis () - buttontime < BUTTON_REPEAT) return;
+  EncButtonState = 1;
+  buttontime = millis ();
 
-  showMode();
+  ScanStop ();
+  setincrement();
+  renderflags |= RENDER_FREQ;
+     
+  lbsmem.rx = rx;
+  lbsmem.bfo = bfo;
+  lbsmem.increment = increment;
+  StepLabel (lbsmem.hertz);
+  flags |= UPDATE;
+}
 
-  if (millis() - timeLapse > EEPROM_WRITE_TIME) {
-    if (flags & UPDATE) {
-      EEPROMWrite (0, (char *)&lbsmem, sizeof(lbsmem));
-      flags &= ~UPDATE;
-    }
-    timeLapse = millis();
-  } 
+void TaskRender (void)
+// Draw whatever changed.  RenderScreen() keeps to FRAME_RATE
+{
+  RenderScreen ();
+}
+
+void TaskSave (void)
+// Not while scanning.  The frequency the scan stops on is saved afterwards
+{
+  if ((flags & UPDATE) && !ScanActive ()) {
+    EEJournalSave (&lbsmem, sizeof(lbsmem));
+    flags &= ~UPDATE;
+  }
 }
 
 void ExecuteSerial (char *str)
 {
   
-// num defined the actual number of entries process from the serial buffer
-// i is a generic counter
-  unsigned char num;
-  unsigned int i;
-  
 // This function called when serial input in present in the serial buffer
 // The serial buffer is parsed and characters and numbers are scraped and entered
-// in the commands[] and numbers[] variables.
-  num = ParseSerial (str);
+// in the commands[] and numbers[] variables.  Entries not entered are zero so the count ParseSerial() returns is not needed
+  ParseSerial (str);
 
 // Process the commands
 // Note: Whenever a parameter is stated as [CLK] the square brackets are not entered. The square brackets means
@@ -403,33 +549,37 @@ void ExecuteSerial (char *str)
   switch (commands[0]) {
 
     // Calibrate the Si5351.
-    // Syntax: C S [CAL] [FREQ], where CAL is the new Calibration value and FREQ is the frequency to output
+    // Syntax: C S [CAL] [FREQ], where CAL is the new Calibration value in parts per billion and FREQ is the frequency to output
+    // Syntax: C S - [CAL] [FREQ], for a negative Calibration value
     // Syntax: C M [CAL], where CAL is the new Calibration value for S Meter
     // Syntax: C M [S], where S is between 1 and 9 to indicate S Level input
     // Syntax: C , If no parameters specified, it will display current calibration values
     case 'C':             // Calibrate
       // First, Check inputs to validate
       if (commands[1] == 'W') {
-        EEPROMWrite(0, (char *)&lbsmem, sizeof(lbsmem));
+        EEJournalSave (&lbsmem, sizeof(lbsmem));
         ResetLBS ();
         
       } else if (commands[1] == 'S') {
-        if (numbers[1] < SI_MIN_OUT_FREQ || numbers[1] > SI_MAX_OUT_FREQ) {
+        if (numbers[1] < SI_MIN_OUT_FREQ || numbers[1] > SI_MAX_OUT_FREQ || numbers[0] > SI_MAX_CORRECTION) {
           ErrorOut ();
           break;
         }
+
+        // ParseSerial() treats the minus sign as a command character
+        if (commands[2] == '-') numbers[0] = -(long)numbers[0];
       
         // New value defined so read the old values and display what will be done
         ReadSettings ();
-        Serial.print ("Old: ");
-        Serial.println (multisynth.correction);
-        Serial.print ("New: ");
-        Serial.println (numbers[0]);
-        Serial.println ("Enter CW to End");
+        TxFlash (PSTR ("Old: "));
+        TxNumber (multisynth.correction);
+        TxFlash (PSTR ("\r\nNew: "));
+        TxNumber ((long)numbers[0]);
+        TxFlash (PSTR ("\r\nEnter CW to End\r\n"));
 
         // Store the new value entered, reset the Si5351 and then display frequency based on new setting     
-        multisynth.correction = lbsmem.correction = numbers[0];
-        EEPROMWrite(0, (char *)&lbsmem, sizeof(lbsmem));
+        multisynth.correction = lbsmem.correction = (long)numbers[0];
+        EEJournalSave (&lbsmem, sizeof(lbsmem));
   
         ResetSi5351 (SI_CRY_LOAD_8PF);
         ReadSettings ();
@@ -441,31 +591,12 @@ void ExecuteSerial (char *str)
       } else if (commands[1] == 'M' && !commands[2]) {
           if (numbers[0] > 1000 && numbers[0] < 10000) {
             lbsmem.uVLevel = numbers[0];
+            SmeterReference ();
           } else if (numbers[0]>4 && numbers[0]<10) { 
-            uvLevel = numbers[0];
-            switch (numbers[0]) {
-              case 9:
-                uvLevel = -34;
-                break;
-              case 8:
-                uvLevel = -34;
-                break;
-              case 7:
-                uvLevel = -34;
-                break;
-              case 6:
-                uvLevel = -34;
-                break;
-              case 5:
-                uvLevel = -34;
-                break;
-              default:
-                uvLevel = 0;
-                ErrorOut ();
-            }  
-            uvLevel = pow(10, -uvLevel/20.0);
+            // S5 to S9 are all taken as -34 dBu.  1uV_ADC_Level = S_ADCLevel x 10^(34/20) (see SMETER_S9_FACTOR)
+            uvLevel = SMETER_S9_FACTOR;
             flags |= CALIBRATE_SMETER;
-            Serial.println ("Enter CW to End");
+            TxFlash (PSTR ("Enter CW to End\r\n"));
             
           } else {
             ErrorOut ();
@@ -474,13 +605,26 @@ void ExecuteSerial (char *str)
       } else if (commands[1] == 'M' && commands[2] == 'O') {
           if (numbers[0] > 100 && numbers[0] < 150) {
             lbsmem.uVOffset = numbers[0];
-            EEPROMWrite(0, (char *)&lbsmem, sizeof(lbsmem));
+            EEJournalSave (&lbsmem, sizeof(lbsmem));
           }
           
       } else if (commands[1] == 'M' && commands[2] == 'D') {
           if (numbers[0] < 20) {
             lbsmem.uVDelay = numbers[0];
-            EEPROMWrite(0, (char *)&lbsmem, sizeof(lbsmem));
+            EEJournalSave (&lbsmem, sizeof(lbsmem));
+          }
+
+      } else if (commands[1] == 'M' && (commands[2] == 'A' || commands[2] == 'R')) {
+          if (numbers[0] <= ADC_MAX_SHIFT) {
+            if (commands[2] == 'A') {
+              lbsmem.uVAttack = numbers[0];
+            } else {
+              lbsmem.uVDecay = numbers[0];
+            }
+            AdcEnvelope (lbsmem.uVAttack, lbsmem.uVDecay);
+            EEJournalSave (&lbsmem, sizeof(lbsmem));
+          } else {
+            ErrorOut ();
           }
           
       } else if (!numbers[0] && !numbers[1]) {
@@ -493,6 +637,191 @@ void ExecuteSerial (char *str)
       DumpEEPROM ();
       break;
 
+    // Si5351 I2C statistics
+    // Syntax: I , display bytes written, bytes skipped by the shadow registers, I2C transactions and failed transactions
+    // Syntax: I R , reset the statistics
+    case 'I':
+      if (commands[1] == 'R') {
+        Si5351ClearStats ();
+      } else {
+        TxFlash (PSTR (" Wr: "));
+        TxUnsigned (si5351stats.writes);
+        TxFlash (PSTR (" Skip: "));
+        TxUnsigned (si5351stats.skipped);
+        TxFlash (PSTR (" I2C: "));
+        TxUnsigned (si5351stats.bursts);
+        TxFlash (PSTR (" Err: "));
+        TxUnsigned (si5351stats.errors);
+        TxNewLine ();
+      }
+      break;
+
+    // Encoder queue statistics
+    // Syntax: E , display steps that overflowed the queue and the deepest the queue has been
+    // Syntax: E R , reset the statistics
+    case 'E':
+      if (commands[1] == 'R') {
+        EncoderReset ();
+      } else {
+        Skinny_Encoder_stats_def enc;
+        EncoderStats (&enc);
+        TxFlash (PSTR (" Ovfl: "));
+        TxUnsigned (enc.overflows);
+        TxFlash (PSTR (" Depth: "));
+        TxUnsigned (enc.maxdepth);
+        TxNewLine ();
+      }
+      break;
+
+
+    // Scanner (see Skinny_Scan.h).  Frequencies are dial frequencies in Hz
+    // Syntax: S , display scan state and channels per second
+    // Syntax: S R [START] [STOP] [STEP], scan a range.  STEP 0 uses the tuning step
+    // Syntax: S C , scan the memory channels
+    // Syntax: S S , stop scanning
+    // Syntax: S W [CH] [FREQ], store FREQ in memory channel CH (0-15).  FREQ 0 clears it
+    // Syntax: S L , list the memory channels
+    // Syntax: S P [SETTLE] [HANG] [LEVEL], settle ms, hang ms and squelch level in S meter pixels.  No values displays them
+    case 'S':
+      if (commands[1] == 'R') {
+        stopScope ();
+        if (!numbers[2]) numbers[2] = increment;
+        if (numbers[0] + bfo <= RX_LOWER_LIMIT || numbers[1] + bfo >= RX_UPPER_LIMIT || numbers[1] <= numbers[0]) {
+          ErrorOut ();
+          break;
+        }
+        ScanRange (numbers[0], numbers[1], numbers[2]);
+        
+      } else if (commands[1] == 'C') {
+        stopScope ();
+        if (!ScanMemory (RX_LOWER_LIMIT - bfo, RX_UPPER_LIMIT - bfo)) ErrorOut ();
+
+      } else if (commands[1] == 'S') {
+        ScanStop ();
+
+      } else if (commands[1] == 'W') {
+        if (numbers[0] >= SCAN_CHANNELS || (numbers[1] && (numbers[1] + bfo <= RX_LOWER_LIMIT || numbers[1] + bfo >= RX_UPPER_LIMIT))) {
+          ErrorOut ();
+          break;
+        }
+        ScanChannelWrite (numbers[0], numbers[1]);
+
+      } else if (commands[1] == 'L') {
+        TxRows (ChannelRow, SCAN_CHANNELS);
+
+      } else if (commands[1] == 'P') {
+        if (numbers[0] || numbers[1] || numbers[2]) {
+          if (numbers[0] > 255 || numbers[1] > 60000 || numbers[2] > 68) {
+            ErrorOut ();
+            break;
+          }
+          ScanSettings (numbers[0], numbers[1], numbers[2]);
+        }
+        TxFlash (PSTR (" Settle: "));
+        TxUnsigned (scansettle);
+        TxFlash (PSTR (" Hang: "));
+        TxUnsigned (scanhang);
+        TxFlash (PSTR (" Level: "));
+        TxUnsigned (scanthreshold);
+        TxNewLine ();
+
+      } else {
+        Skinny_Scan_stats_def scan;
+        ScanStats (&scan);
+        TxFlash (ScanActive () ? PSTR (" Scan: ") : PSTR (" Stopped: "));
+        TxUnsigned (rx - bfo);
+        TxFlash (PSTR (" Lvl: "));
+        TxUnsigned (scan.level);
+        TxFlash (PSTR (" Ch: "));
+        TxUnsigned (scan.channels);
+        TxFlash (PSTR (" Stops: "));
+        TxUnsigned (scan.stops);
+        TxFlash (PSTR (" Ch/s: "));
+        TxUnsigned (scan.elapsed ? scan.channels * 1000 / scan.elapsed : 0);
+        TxFlash (PSTR (" Retune us: "));
+        TxUnsigned (retuneus);
+        TxNewLine ();
+      }
+      break;
+
+    // Bandscope (see Skinny_Scope.h)
+    // Syntax: B [SPAN], show the bandscope for SPAN Hz around the dial frequency (0 for 25 kHz).  Again to change the span
+    // Syntax: B S , back to the normal screen
+    // Syntax: B I , display sweeps per second
+    case 'B':
+      if (commands[1] == 'S') {
+        stopScope ();
+      } else if (commands[1] == 'I') {
+        Skinny_Scope_stats_def scope;
+        ScopeStats (&scope);
+        TxFlash (PSTR (" Sweeps: "));
+        TxUnsigned (scope.sweeps);
+        TxFlash (PSTR (" ms: "));
+        TxUnsigned (scope.sweepms);
+        TxFlash (PSTR (" Sweeps/s x10: "));
+        TxUnsigned (scope.sweepms ? 10000UL / scope.sweepms : 0);
+        TxFlash (PSTR (" us/point: "));
+        TxUnsigned (scope.sweepms * 1000UL / SCOPE_POINTS);
+        TxNewLine ();
+      } else if (numbers[0] > 200000 || (numbers[0] && numbers[0] < SCOPE_POINTS)) {
+        ErrorOut ();
+      } else {
+        startScope (numbers[0]);
+      }
+      break;
+
+    // RAM use (see Skinny_Mem.h)
+    // Syntax: M , display free RAM now and at least, stack high water mark, heap and the call site depths
+    // Syntax: M R , repaint the free RAM and clear the high water marks
+    case 'M':
+      if (commands[1] == 'R') {
+        MemReset ();
+      } else {
+        Skinny_Mem_stats_def mem;
+        MemStats (&mem);
+        TxFlash (PSTR (" Free: "));
+        TxUnsigned (mem.free);
+        TxFlash (PSTR (" Min: "));
+        TxUnsigned (mem.minfree);
+        TxFlash (PSTR (" Stack: "));
+        TxUnsigned (mem.stack);
+        TxFlash (PSTR (" Heap: "));
+        TxUnsigned (mem.heap);
+#if MEM_SITES
+        TxFlash (PSTR (" Tune: "));
+        TxUnsigned (mem.site[MEM_SITE_TUNE]);
+        TxFlash (PSTR (" Console: "));
+        TxUnsigned (mem.site[MEM_SITE_CONSOLE]);
+#endif
+        TxNewLine ();
+      }
+      break;
+
+#if PROF_ENABLE
+    // Main loop profiler (see Skinny_Prof.h)
+    // Syntax: P , for each stage display the count, min, mean and max in us and the histogram
+    // Syntax: P R , reset the profiler
+    case 'P':
+      if (commands[1] == 'R') {
+        ProfReset ();
+      } else {
+        TxFlash (PSTR (" Stage n min avg max (us) / <64 <256 <1m <4m more\r\n"));
+        TxRows (ProfRow, PROF_STAGES);
+      }
+      break;
+#endif
+
+    // Scheduler (see Skinny_Sched.h)
+    // Syntax: T , for each task display the period in ms, budget in us, runs, overruns and max in us
+    // Syntax: T R , reset the task statistics
+    case 'T':
+      if (commands[1] == 'R') {
+        SchedReset ();
+      } else {
+        TxFlash (PSTR (" Task period budget runs over max\r\n"));
+        TxRows (TaskRow, SchedCount ());
+      }
+      break;
 
     // Help Screen. This consumes a ton of memory but necessary for those
     // without much computer or programming experience.
@@ -524,30 +853,188 @@ void ExecuteSerial (char *str)
 
 
 
-void DumpEEPROM (void)
+void CatExecute (unsigned int cmd, unsigned char digits, unsigned long value)
+// Runs a CAT command (see Skinny_CAT.h).  digits is the number of digits after the command and value what they hold.
+// Changes are picked up by loop() the same way as the encoder and buttons so the radio is retuned and redrawn there.
 {
   unsigned char i;
-  
+
+  switch (cmd) {
+    case CAT_CMD('F', 'A'):           // Dial frequency is rx - bfo, see showFreq()
+      if (!digits) {
+        CatReply (cmd, rx - bfo, 11);
+      } else if (value + bfo > RX_LOWER_LIMIT && value + bfo < RX_UPPER_LIMIT) {
+        ScanStop ();
+        rx = value + bfo;
+      } else {
+        CatError ();
+      }
+      break;
+
+    case CAT_CMD('M', 'D'):           // 1 = LSB, 2 = USB
+      if (!digits) {
+        CatReply (cmd, LSB_Mode ? 1 : 2, 1);
+      } else if (value == 1 || value == 2) {
+        LSB_Mode = (value == 1);
+      } else {
+        CatError ();
+      }
+      break;
+
+    case CAT_CMD('S', 'M'):           // Bar is 0 to 68 pixels, TS-480 reports 0 to 30
+      TxFlash (PSTR ("SM0"));
+      TxDigits ((unsigned int)smeter * 30 / 68, 4);
+      TxChar (';');
+      break;
+
+    case CAT_CMD('S', 'T'):           // setincrement() cycles through the 6 steps so at most 6 calls reach any of them
+      if (!digits) {
+        CatReply (cmd, increment, 7);
+        break;
+      }
+      for (i = 0; i < 6 && increment != (long)value; i++) setincrement ();
+      if (increment != (long)value) {
+        CatError ();
+        break;
+      }
+      lbsmem.increment = increment;
+      StepLabel (lbsmem.hertz);
+      flags |= UPDATE;
+      renderflags |= RENDER_FREQ;
+      break;
+
+    case CAT_CMD('I', 'F'):           // TS-480 status.  Only the frequency and mode are real
+      TxFlash (PSTR ("IF"));
+      TxDigits (rx - bfo, 11);
+      TxFlash (PSTR ("     +0000000000"));
+      TxChar (LSB_Mode ? '1' : '2');
+      TxFlash (PSTR ("0000000;"));
+      break;
+
+    case CAT_CMD('I', 'D'):           // TS-480
+      CatReply (cmd, 20, 3);
+      break;
+
+    case CAT_CMD('P', 'S'):           // Power is on
+      CatReply (cmd, 1, 1);
+      break;
+
+    case CAT_CMD('A', 'I'):           // Auto information is not supported
+      if (!digits) CatReply (cmd, 0, 1);
+      break;
+
+    default:
+      CatError ();
+  }
+}
+
+
+void DumpEEPROM (void)
+{
   ReadSettings (); 
-  Serial.print (" Si: ");
-  Serial.print (lbsmem.correction);
-  Serial.print (" Sm: ");
-  Serial.print (lbsmem.uVLevel);
-  Serial.print (" Off: ");
-  Serial.print (lbsmem.uVOffset);
-  Serial.print (" Dly: ");
-  Serial.print (lbsmem.uVDelay);
-  Serial.print (" Rx: ");
-  Serial.print (lbsmem.rx);
-  Serial.print (" Inc: ");
-  Serial.print (lbsmem.increment);
-  Serial.print (" BFO: ");
-  Serial.print (lbsmem.bfo);
-  Serial.print (" Txt: ");
-  for (i=0; i<sizeof(lbsmem.hertz); i++) Serial.print (lbsmem.hertz[i]);
-  Serial.println();     
+  TxRows (DumpRow, 3);
+}
+
+void DumpRow (unsigned char row)
+// One part of the D reply for TxRows().  The reply is longer than the TX queue
+{
+  unsigned char i;
+
+  switch (row) {
+    case 0:
+      TxFlash (PSTR (" Si: "));
+      TxNumber (lbsmem.correction);
+      TxFlash (PSTR (" Sm: "));
+      TxUnsigned (lbsmem.uVLevel);
+      TxFlash (PSTR (" Off: "));
+      TxUnsigned (lbsmem.uVOffset);
+      TxFlash (PSTR (" Dly: "));
+      TxUnsigned (lbsmem.uVDelay);
+      TxFlash (PSTR (" Att: "));
+      TxUnsigned (lbsmem.uVAttack);
+      TxFlash (PSTR (" Dec: "));
+      TxUnsigned (lbsmem.uVDecay);
+      break;
+    case 1:
+      TxFlash (PSTR (" Rx: "));
+      TxUnsigned (lbsmem.rx);
+      TxFlash (PSTR (" Inc: "));
+      TxUnsigned (lbsmem.increment);
+      TxFlash (PSTR (" BFO: "));
+      TxUnsigned (lbsmem.bfo);
+      TxFlash (PSTR (" Txt: "));
+      for (i=0; i<sizeof(lbsmem.hertz) && lbsmem.hertz[i]; i++) TxChar (lbsmem.hertz[i]);
+      break;
+    default:
+      TxFlash (PSTR (" Slot: "));
+      TxUnsigned (EEJournalSlot ());
+      TxFlash (PSTR (" Seq: "));
+      TxUnsigned (EEJournalSeq ());
+      TxFlash (PSTR (" Pend: "));
+      TxUnsigned (EEPending ());
+      TxNewLine ();     
+  }
+}
+
+void ChannelRow (unsigned char row)
+// SL reply, one memory channel per row
+{
+  TxUnsigned (row);
+  TxFlash (PSTR (": "));
+  TxUnsigned (ScanChannelRead (row));
+  TxNewLine ();
 }
 
+void TaskRow (unsigned char row)
+// T reply, one scheduler task per row
+{
+  Skinny_Task_def task;
+  Skinny_Sched_stats_def sched;
+
+  SchedTask (row, &task);
+  SchedStats (row, &sched);
+  TxChar (' ');
+  TxFlash (ProfName (task.prof));
+  TxChar (' ');
+  TxUnsigned (task.period);
+  TxChar (' ');
+  TxUnsigned (task.budget);
+  TxChar (' ');
+  TxUnsigned (sched.runs);
+  TxChar (' ');
+  TxUnsigned (sched.overruns);
+  TxChar (' ');
+  TxUnsigned (sched.max);
+  TxNewLine ();
+}
+
+#if PROF_ENABLE
+void ProfRow (unsigned char row)
+// P reply, one profiler stage per row
+{
+  Skinny_Prof_stats_def prof;
+  unsigned char i;
+
+  ProfStats (row, &prof);
+  TxChar (' ');
+  TxFlash (ProfName (row));
+  TxChar (' ');
+  TxUnsigned (prof.count);
+  TxChar (' ');
+  TxUnsigned (prof.min);
+  TxChar (' ');
+  TxUnsigned (prof.count ? prof.total / prof.count : 0);
+  TxChar (' ');
+  TxUnsigned (prof.max);
+  TxFlash (PSTR (" /"));
+  for (i = 0; i < PROF_BUCKETS; i++) {
+    TxChar (' ');
+    TxUnsigned (prof.hist[i]);
+  }
+  TxNewLine ();
+}
+#endif
+
 #ifdef UPDATE_EEPROM  
 void LoadEEMessage (void)
 {
@@ -555,7 +1042,8 @@ void LoadEEMessage (void)
   unsigned int i, j;
   unsigned int eeaddr;
 
-  Serial.println ("+++ to end");
+  TxFlush ();         // The loader below writes to Serial directly
+  Serial.println (F("+++ to end"));
   eeaddr = MSGSTART;
   i = 0;
   EEPROMWrite (eeaddr, (char *)&i, sizeof(i));
@@ -565,25 +1053,34 @@ void LoadEEMessage (void)
   eeaddr = MSGSTART + sizeof(i);     
   timeLapse = millis();
 
-  while ( i < (MAXEEPROM-MSGSTART-2) && timeLapse && (millis()-timeLapse)< 240000) {
+  // Keep reading to the "+++" even when the message is too long so the rest
+  // is not taken as commands.  Nothing is written past MAXEEPROM: the scanner
+  // channels live there.
+  while (timeLapse && (millis()-timeLapse)< 240000) {
     while (Serial.available() > 0) {
       tmp = Serial.read();
       if (tmp == '+' && j++ >= 2) {          // End data input with "+++" detected
           timeLapse = 0;
       } else if (tmp != '+') {
-        Serial.print (MAXEEPROM-MSGSTART-2-i);
-        Serial.print (":");
-        Serial.println (tmp);
-        EEPROM.write(eeaddr, tmp);
+        if (i < (MAXEEPROM-MSGSTART-2)) {
+          Serial.print (MAXEEPROM-MSGSTART-2-i);
+          Serial.print (':');
+          Serial.println (tmp);
+          EEWrite(eeaddr, tmp);
+          eeaddr++;
+        }
         i++;
-        eeaddr++;
      }
     }  
    
   }
   
   timeLapse = millis();  
-  if (i) {
+  if (i > (MAXEEPROM-MSGSTART-2)) {
+    Serial.print (F("Message too long, max "));
+    Serial.print (MAXEEPROM-MSGSTART-2);
+    Serial.println (F(" characters. Not saved"));
+  } else if (i) {
     eeaddr = MSGSTART;
     EEPROMWrite (eeaddr, (char *)&i, sizeof(i));
   }
@@ -592,39 +1089,37 @@ void LoadEEMessage (void)
 
 void ReadEEMessage (void)
 {
-  unsigned int i, j;
+  unsigned int i;
   char tmp;
   unsigned int len;
   unsigned int eeaddr;
 
+  TxFlush ();         // This writes to Serial directly
   eeaddr = MSGSTART;
   EEPROMRead (eeaddr, (char *)&len, sizeof(len));
   Serial.println (len);
   
-  if (len <= 10 || len > (MAXEEPROM-MSGSTART-2)) {
+  if (len > (MAXEEPROM-MSGSTART-2)) {
+    Serial.println (F("Bad message length, reload it with L"));
+    return;
+  }
+  if (len <= 10) {
     return;
   }
   
   eeaddr = MSGSTART + sizeof(len);
   for (i=0; i<len; i++) {
-    tmp = EEPROM.read(eeaddr+i);
+    tmp = EERead(eeaddr+i);
     Serial.print (tmp);
     Serial.flush();
   }
 }  
 #else
 void pgmMessage (const char *msg) 
+// Queues a message kept in program memory.  It is sent in the background by TxPump()
 {
-  char tmp = 0xd;
-  int i = 0;
-  
-  while (tmp) {
-    tmp = (char)pgm_read_byte(msg+i);
-    i++;
-    if (tmp) Serial.print (tmp);
-  }
-  Serial.println("\r\n");
-
+  TxFlash (msg);
+  TxFlash (PSTR ("\r\n\r\n"));
 }
 #endif 
 
@@ -637,7 +1132,7 @@ void EEPROMWrite (unsigned int memAddr, char *cptr, unsigned int memlen)
 {
   unsigned int i;
   for (i=0; i<memlen; i++) {
-    EEPROM.write((memAddr+i), (unsigned char)*cptr);
+    EEWrite((memAddr+i), (unsigned char)*cptr);     // Queued, only bytes that changed are programmed
     cptr++;
   }
 }
@@ -647,7 +1142,7 @@ void EEPROMRead (unsigned int memAddr, char *cptr, unsigned int memlen)
 {
   unsigned int i;
   for (i=0; i<memlen; i++) {
-    *cptr =  EEPROM.read(memAddr+i);
+    *cptr =  EERead(memAddr+i);
     cptr++;
   }
 }
@@ -655,20 +1150,30 @@ void EEPROMRead (unsigned int memAddr, char *cptr, unsigned int memlen)
 
 void ReadSettings (void)
 {
-  EEPROMRead(0, (char *)&lbsmem, sizeof(lbsmem)); 
+  // Newest good record in the journal.  Radios updated from older firmware have no journal yet so
+  // fall back to the settings at address 0 (bad values are replaced with defaults below).
+  // That firmware kept the correction in parts per 10 million so it is converted to ppb here
+  if (!EEJournalLoad (&lbsmem, sizeof(lbsmem))) {
+    EEPROMRead(0, (char *)&lbsmem, sizeof(lbsmem)); 
+    if (lbsmem.correction < -LEGACY_MAX_CORRECTION || lbsmem.correction > LEGACY_MAX_CORRECTION) {
+      lbsmem.correction = 1;
+    } else lbsmem.correction *= LEGACY_CORRECTION_PPB;
+  }
 
   increment = lbsmem.increment;
   rx = lbsmem.rx;
   bfo = lbsmem.bfo;
-  hertz = String (lbsmem.hertz);
   
-  if (lbsmem.correction < -1000 || lbsmem.correction > 1000) {
+  // Correction is in parts per billion
+  if (lbsmem.correction < -SI_MAX_CORRECTION || lbsmem.correction > SI_MAX_CORRECTION) {
     multisynth.correction = lbsmem.correction = 1;
   } else multisynth.correction = lbsmem.correction;
  
-  if (increment > 100000) {
-    increment = 100;
-    hertz = " 100";
+  // Erased EEPROM reads as -1 which is not a step
+  for (stepidx = 0; stepidx < TUNE_STEPS && (long)pgm_read_dword (&tunesteps[stepidx].increment) != increment; stepidx++);
+  if (stepidx >= TUNE_STEPS) {
+    stepidx = TUNE_STEP_DEFAULT;
+    increment = pgm_read_dword (&tunesteps[stepidx].increment);
   }
  
   if (rx < LOW_RX_FREQ || rx > HIGH_RX_FREQ) {
@@ -677,36 +1182,35 @@ void ReadSettings (void)
   if (bfo < LSB_BFO_FREQ || bfo > LSB_BFO_FREQ) {
     bfo = LSB_BFO_FREQ;
   }  
+
+  if (lbsmem.uVAttack > ADC_MAX_SHIFT || lbsmem.uVDecay > ADC_MAX_SHIFT) {
+    lbsmem.uVAttack = SMETER_ATTACK;
+    lbsmem.uVDecay = SMETER_DECAY;
+  }
+  AdcEnvelope (lbsmem.uVAttack, lbsmem.uVDecay);
+
+  SmeterReference ();
 }  
 
 
 void setincrement (void) 
+// Next step in tunesteps[], back to the first after the last
 {
-  if (increment == 10) {
-    increment = 100;
-    hertz = "100";
-  } else if (increment == 100) {
-    increment = 1000;
-    hertz = " 1K";
-  } else if (increment == 1000) {
-    increment = 10000;
-    hertz = "10K";
-  } else if (increment == 10000) {
-    increment = 100000;
-    hertz = "1xK";
-  } else if (increment == 100000) {
-    increment = 1000000;
-    hertz = " 1M";
-  } else {
-    increment = 10;
-    hertz = " 10";
-  };
-  
+  if (++stepidx >= TUNE_STEPS) stepidx = 0;
+  increment = pgm_read_dword (&tunesteps[stepidx].increment);
+}
+
+void StepLabel (char *label)
+// Copies the label of the current step (4 bytes with the terminator)
+{
+  strcpy_P (label, tunesteps[stepidx].label);
 }
 
 
 void showFreq (void) 
 {
+  unsigned char ones, tens, hundreds, thousands, tenthousands, hundredthousands, millions; //Placeholders
+
   // Clear the display
   display.fillRect(0, 0, 84, 16, WHITE); 
   
@@ -741,9 +1245,7 @@ void showFreq (void)
 
 // Display Increment
   display.setCursor(60, 8);
-  display.print(hertz);
-
-  display.display();
+  display.print((const __FlashStringHelper *)tunesteps[stepidx].label);
 
 }
 
@@ -753,13 +1255,13 @@ void setupScreen (void)
   display.setTextSize(1);
   display.setTextColor(BLACK);
   display.setCursor (24, 18);
-  display.print("PARC50-LBS");
+  display.print(F("PARC50-LBS"));
   display.setCursor (60, 26);
-  display.print("XCVR");
+  display.print(F("XCVR"));
   display.setCursor (40, 26);
-  display.print("SSB");
+  display.print(F("SSB"));
   display.setCursor (20, 26);
-  display.print("40M");
+  display.print(F("40M"));
 
 
   display.fillRect(1, 35, 83, 12, WHITE); // Makes S Mtr Background & tick marks for scaling the S Meter  S1, S3, S5, S9, 30/9
@@ -774,7 +1276,7 @@ void setupScreen (void)
   display.setTextSize(1);
   display.setTextColor(WHITE);
   display.setCursor(3, 38);
-  display.print("S=");
+  display.print(F("S="));
   display.setTextSize(1);
   
 //  display.setTextSize(1);
@@ -782,43 +1284,88 @@ void setupScreen (void)
 //  display.setCursor(3, 38);
 //  display.print("by VE3OOI");
  
-  display.display();
+  display.flush();
 }
 
 
-unsigned int peakDetect (unsigned int samples)
+void readSmeter (void) 
+// Reads the signal envelope kept by the ADC ISR and asks for the S meter to be redrawn if the reading moved.
+// Returns straight away if the ADC has not finished a new window (100 samples) since the last call.
 {
-  unsigned int i;
-  unsigned long pkVoltage;
-  int AnalogVoltIn = 0;
+  Skinny_ADC_result_def adc;
+  unsigned int rmsVoltage;
+  int SMeterVal = 0;
+
+  if (!AdcResult (&adc)) return;
 
-  pkVoltage = 0;
-  for (i=0; i<samples; i++) {
-    AnalogVoltIn = analogRead(SENSOR);
-    if (AnalogVoltIn > pkVoltage) pkVoltage = AnalogVoltIn;
+  // The envelope follows the peaks (fast attack, slow decay) so convert to RMS as peak detect did
+  rmsVoltage = ((unsigned long)AdcLevel () * 707) / 1000;
+  if (!rmsVoltage) rmsVoltage = 1;
+
+  if (flags & CALIBRATE_SMETER) {
+    lbsmem.uVLevel = rmsVoltage * uvLevel;
+    SmeterReference ();
   }
-  
-  pkVoltage = (pkVoltage * 707)/1000; 
- 
-  return (unsigned int)pkVoltage; 
-}  
 
-void showSmeter (void) 
+  SMeterVal = SmeterBar (rmsVoltage);
+  if (SMeterVal != smeter) {
+    smeter = SMeterVal;
+    renderflags |= RENDER_SMETER;
+  }
+}
+
+unsigned char SmeterBar (unsigned int rms)
+// S meter bar length in pixels (1 to 68) for an RMS level in ADC counts
 {
-  unsigned int rmsVoltage;
-  int SMeterVal = 0;
+  int SMeterVal;
 
-  rmsVoltage = peakDetect (PKDETECT_SAMPLES);
-  if (!rmsVoltage) rmsVoltage = 1;
+  if (!rms) rms = 1;
 
-  SMeterVal = 20 * log( (double)rmsVoltage/(double)lbsmem.uVLevel);
+  // 20 x ln(rmsVoltage / uVLevel) in whole units, truncated like the integer conversion of the original double
+  SMeterVal = ((int)Log20 (rms) - (int)uvLevelLog) / LOG20_ONE;
 
   SMeterVal += lbsmem.uVOffset;
   if (SMeterVal < 0) SMeterVal = 1;
   if (SMeterVal > 68) SMeterVal = 68;
+  return SMeterVal;
+}
+
+// 20 x ln(1 + i/32) x LOG20_ONE for i = 0 to 32.  Used by Log20() for the mantissa
+const unsigned int log20table[33] PROGMEM = {
+    0,  39,  78, 115, 151, 186, 220, 253, 286, 317, 348, 378, 408, 436, 465, 492, 519,
+  545, 571, 597, 621, 646, 670, 693, 716, 739, 761, 783, 805, 826, 847, 867, 887};
+
+unsigned int Log20 (unsigned int v)
+// Returns 20 x ln(v) in 1/LOG20_ONE units with integer maths only (0 for v = 0 or 1).
+// v = m x 2^e with m in 1..2 so 20 ln(v) = e x 20 ln(2) + 20 ln(m).  20 ln(m) is interpolated from log20table[]
+// using the 5 bits below the leading one for the entry and the next 10 bits for the interpolation.  Error is below 0.1.
+{
+  unsigned char e = 15, i;
+  unsigned int lo, hi, frac;
+
+  if (v < 2) return 0;
+  while (!(v & 0x8000)) {
+    v <<= 1;
+    e--;
+  }
+  i = (v >> 10) & 0x1F;
+  frac = v & 0x3FF;
+  lo = pgm_read_word (&log20table[i]);
+  hi = pgm_read_word (&log20table[i + 1]);
+
+  return e * LOG20_LN2 + lo + (unsigned int)(((unsigned long)(hi - lo) * frac) >> 10);
+}
+
+void SmeterReference (void)
+// Call whenever lbsmem.uVLevel changes.  readSmeter() only needs Log20() of the new reading after this
+{
+  uvLevelLog = Log20 (lbsmem.uVLevel);
+}
+
+void showSmeter (void) 
+{
   display.fillRect(16, 40, 83, 3, BLACK);
-  display.fillRect(16, 40, SMeterVal, 3, WHITE);
-  display.display();
+  display.fillRect(16, 40, smeter, 3, WHITE);
 }
 
 void showMode (void)
@@ -831,11 +1378,10 @@ void showMode (void)
   
   //Use LSB_BTN to determing mode.
   if (LSB_Mode) { 
-    display.println("LSB");
+    display.println(F("LSB"));
   }else{
-    display.println("USB");
+    display.println(F("USB"));
   }
-  display.display();
   display.setTextColor(BLACK);
 }
 
@@ -846,12 +1392,11 @@ void showTune (void)
   display.fillRect(0, 0, 8, 25, BLACK); //
   display.setTextColor(WHITE); // white text on black background
   display.setCursor(1, 1);  // top left corner
-  display.print("T");
+  display.print('T');
   display.setCursor(1, 9);
-  display.print("U");
+  display.print('U');
   display.setCursor(1, 17);
-  display.print("N");
-  display.display();
+  display.print('N');
   display.setTextColor(BLACK);
 }  
 
@@ -859,18 +1404,96 @@ void clearTune (void)
 {
   display.setTextSize(1);    // This prints a white rectangle over the black TUNE and makes it disappear from the scereen
   display.fillRect(0, 0, 8, 25, WHITE);
-  display.display();
   display.setTextColor(BLACK);
 }  
 
+void startScope (unsigned long span)
+// Switches the screen to the bandscope, or changes the span if it is already showing
+{
+  ScanStop ();
+  if (!ScopeActive ()) {
+    display.clearDisplay ();
+    display.invalidate ();
+  }
+  ScopeStart (rx - bfo, span);
+  renderflags |= RENDER_FREQ;
+}
+
+void stopScope (void)
+// Back to the normal screen with CLK0 on the dial frequency
+{
+  if (!ScopeActive ()) return;
+  ScopeStop ();
+  rx2 = 1;                            // loop() retunes CLK0
+  display.clearDisplay ();
+  display.invalidate ();
+  setupScreen ();
+  renderflags |= RENDER_FREQ | RENDER_MODE | RENDER_SMETER | RENDER_TUNE;
+}
+
+void showScopeHeader (void)
+// Dial frequency in kHz and the span on the top line with a tick over the centre column
+{
+  display.fillRect(0, 0, 84, SCOPE_TOP, WHITE);
+  display.setTextSize(1);
+  display.setTextColor(BLACK);
+  display.setCursor(0, 0);
+  display.print((rx - bfo) / 1000);
+  display.print('.');
+  display.print(((rx - bfo) / 100) % 10);
+  display.print(F(" +/-"));
+  display.print(ScopeSpan () / 2000);
+  display.print('k');
+  display.fillRect(SCOPE_POINTS / 2, SCOPE_TOP - 1, 1, 1, BLACK);
+}
+
+void showScopePoint (unsigned char x, unsigned int level)
+// Draws one bandscope column.  The height uses the S meter scale so the plot is in dB like the meter
+{
+  unsigned char h = (unsigned int)SmeterBar (((unsigned long)level * 707) / 1000) * SCOPE_HEIGHT / 68;
+
+  display.fillRect(x, SCOPE_TOP, 1, SCOPE_HEIGHT - h, WHITE);
+  display.fillRect(x, SCOPE_TOP + SCOPE_HEIGHT - h, 1, h, BLACK);
+  renderflags |= RENDER_SCOPE;
+}
+
+void RenderScreen (void)
+// Draws everything flagged in renderflags and sends it to the display in one flush.
+// Runs at most once every FRAME_TIME ms so a fast spin of the knob costs one redraw per frame, not one per step.
+{
+  if (!renderflags || millis() - frametime < FRAME_TIME) return;
+  frametime = millis();
+
+  // The bandscope has the whole screen.  Its columns are drawn as they are measured so only the header is left
+  if (ScopeActive ()) {
+    if (renderflags & RENDER_FREQ) showScopeHeader();
+    renderflags = 0;
+    display.flush();
+    return;
+  }
+
+  if (renderflags & RENDER_FREQ) showFreq();
+  if (renderflags & RENDER_MODE) showMode();
+  if (renderflags & RENDER_SMETER) showSmeter();
+  if (renderflags & RENDER_TUNE) {
+    if (TuneButtonState == LOW) {
+      showTune();
+    } else {
+      clearTune();
+    }
+  }
+  renderflags = 0;
+
+  display.flush();
+}
+
 void checkMode() {
   // creates a momentary tuning pulse @ 50% duty cycle and makes 'TUN' appear on the screen
   TuneButtonState = digitalRead(TUNE_BTN); 
   if (TuneButtonState != lastButtonState) {
     if (TuneButtonState == LOW) {
       digitalWrite(XMIT_ON, HIGH);
-      showTune();
-      delay(10);
+      renderflags |= RENDER_TUNE;
       //
       //   toneAC( frequency [, volume [, length [, background ]]] ) - Play a note.
       //     Parameters:
@@ -889,7 +1512,7 @@ void checkMode() {
    
     } else {
       digitalWrite(XMIT_ON, LOW);
-      clearTune();
+      renderflags |= RENDER_TUNE;
       toneAC();  //turn off tone
       
 // Force BFO to change back to LSB and USB frequencies      
@@ -7,14 +7,60 @@ void showFreq (void);
 void setincrement (void); 
 void setupScreen (void);
 void showTune (void);
+void showMode (void);
+void clearTune (void);
+void checkMode (void);
+void readSmeter (void);
+void RenderScreen (void);
+unsigned int Log20 (unsigned int v);
+void SmeterReference (void);
+unsigned char SmeterBar (unsigned int rms);
+void startScope (unsigned long span);
+void stopScope (void);
+void showScopeHeader (void);
+void showScopePoint (unsigned char x, unsigned int level);
+void TaskSerial (void);
+void TaskSweep (void);
+void TaskTune (void);
+void TaskSmeter (void);
+void TaskButtons (void);
+void TaskRender (void);
+void TaskSave (void);
 
 // Flags
 #define UPDATE 1
 #define CALIBRATE_SI5351 2
 #define CALIBRATE_SMETER 4
 
-#define PKDETECT_SAMPLES 100  
+// Parts of the screen waiting to be redrawn.  See RenderScreen()
+#define RENDER_FREQ   1
+#define RENDER_MODE   2
+#define RENDER_SMETER 4
+#define RENDER_TUNE   8
+#define RENDER_SCOPE  16                // Bandscope columns were drawn, only needs a flush
+
+#define SCOPE_TOP     9                 // Bandscope plot, below the one line header
+#define SCOPE_HEIGHT  39
+
+#define FRAME_RATE 25                   // Max screen updates per second
+#define FRAME_TIME (1000 / FRAME_RATE)  // ms
+
+#define TASK_SMETER_PERIOD 50           // ms, S meter at 20 Hz
+#define TASK_BUTTON_PERIOD 20           // ms, also the debounce time
+#define BUTTON_REPEAT      200          // ms between step changes while the encoder button is held
+
+#define SMETER_PRESCALER ADC_PS_128   // 9.6 kHz sampling.  See Skinny_ADC.h
+#define SMETER_DECIMATE  0            // Keep every sample
 #define SMETER_CALIBRATION -34
+#define SMETER_S9_FACTOR   50       // 10^(34/20) = 50.1, see CM command
+
+#define SMETER_ATTACK      6        // 6.7 ms at 9.6 kHz
+#define SMETER_DECAY       12       // 426 ms
+
+#define LOG20_ONE 64                // Log20() returns 20 x ln(v) x LOG20_ONE
+#define LOG20_LN2 887               // 20 x ln(2) x LOG20_ONE
+
+#define SERIAL_BAUD 38400          // Console and CAT.  At 16 MHz with U2X 115200 is 2.1% off (marginal) and 38400 is 0.2%
 
 #define EEPROM_WRITE_TIME 60000    // Ever 1 minutes update EEPROM   
 #define LSB_BFO_FREQ 4913700L
@@ -24,18 +70,36 @@ void showTune (void);
 #define  HIGH_RX_FREQ    12213700
 #define  DEFAULT_RX_FREQ 12113700
 
+#define  RX_UPPER_LIMIT  12216700    // rx must stay below this (upper VFO limit)
+#define  RX_LOWER_LIMIT  11913700    // rx must stay above this (lower VFO limit)
+
+// Tuning steps cycled by the encoder button.  See tunesteps[]
+#define TUNE_STEPS        6
+#define TUNE_STEP_DEFAULT 1         // 100 Hz
+
+typedef struct {
+  unsigned long increment;
+  char label[4];                    // Shown next to the frequency
+} tune_step_def;
+
 #define HELPMSG sizeof(lbs_struture);
 
 void EEPROMWrite (unsigned int memAddr, char *ptr, unsigned int memlen);
 void EEPROMRead (unsigned int memAddr, char *ptr, unsigned int memlen);
 void ReadSettings (void);
 void ExecuteSerial (char *str);
+void CatExecute (unsigned int cmd, unsigned char digits, unsigned long value);
 void ResetLBS (void); 
-unsigned int peakDetect (unsigned int samples);
+void ApplyEncoderSteps (int steps);
 void ReadEEMessage (void);
 void LoadEEMessage (void);
 void pgmMessage (const char *msg);
 void DumpEEPROM (void);
+void DumpRow (unsigned char row);
+void ChannelRow (unsigned char row);
+void TaskRow (unsigned char row);
+void ProfRow (unsigned char row);
+void StepLabel (char *label);
 
 typedef struct {
   long int correction;
@@ -45,12 +109,18 @@ typedef struct {
   unsigned int uVLevel;
   unsigned int uVOffset;
   unsigned int uVDelay;
-  char hertz[5];
+  char hertz[5];                // Step label, kept so the saved settings layout does not change
+  unsigned char uVAttack;       // S meter envelope attack and decay (shift counts, see Skinny_ADC.h)
+  unsigned char uVDecay;
 } lbs_struture;
 
+// Settings at address 0 written by the V1.2 firmware have the correction in parts per 10 million (+/- 1000)
+#define LEGACY_MAX_CORRECTION 1000
+#define LEGACY_CORRECTION_PPB 100
+
 #define MSGSTART sizeof(lbs_struture)
 #define MAXMSGBUF 100
-#define MAXEEPROM 512
+#define MAXEEPROM 448              // Scanner memory channels from here (Skinny_Scan.h), settings journal from 512
 
 
 #endif // _MAIN_H_
@@ -6,6 +6,7 @@
 #define Rotary_h
 
 #include "Arduino.h"
+#include <avr/pgmspace.h>
 
 // Enable this to emit codes twice per step.
 // #define HALF_STEP
@@ -21,6 +22,14 @@
 // Counter-clockwise step.
 #define DIR_CCW 0x20
 
+// Rows in the state table (in flash, see Rotary.cpp)
+#ifdef HALF_STEP
+#define R_STATES 6
+#else
+#define R_STATES 7
+#endif
+extern const unsigned char ttable[R_STATES][4] PROGMEM;
+
 class Rotary
 {
   public:
@@ -32,6 +41,50 @@ class Rotary
     unsigned char pin2;
 };
 
+/*
+ * Same decoder with the pins fixed at compile time.  The port and bit masks fold to constants so
+ * process() is one PIN register read, a table lookup in flash and no calls.  Both pins must be on
+ * the same port (ATmega328: D0-D7 PORTD, D8-D13 PORTB, A0-A5 PORTC).  Use it from an ISR in place of
+ * Rotary, e.g. RotaryFast<2, 3> encoder;
+ */
+template <unsigned char PinA, unsigned char PinB>
+class RotaryFast
+{
+  public:
+    RotaryFast() {
+      pinMode(PinA, INPUT);
+      pinMode(PinB, INPUT);
+#ifdef ENABLE_PULLUPS
+      digitalWrite(PinA, HIGH);
+      digitalWrite(PinB, HIGH);
+#endif
+      state = 0;      // R_START
+    }
+
+    inline unsigned char process() __attribute__((always_inline)) {
+      unsigned char pins = readPort();
+      unsigned char pinstate = ((pins >> pinBit(PinB)) & 1) << 1 | ((pins >> pinBit(PinA)) & 1);
+
+      state = pgm_read_byte(&ttable[state & 0xf][pinstate]);
+      return state & 0x30;
+    }
+
+  private:
+    static inline unsigned char pinPort(unsigned char pin) { return pin < 8 ? 0 : (pin < 14 ? 1 : 2); }
+    static inline unsigned char pinBit(unsigned char pin) { return pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14); }
+    static inline unsigned char readPort() __attribute__((always_inline)) {
+      // PinA is a template constant so only one of these reads is compiled
+      if (pinPort(PinA) == 0) return PIND;
+      if (pinPort(PinA) == 1) return PINB;
+      return PINC;
+    }
+
+    static_assert(PinA < 20 && PinB < 20, "RotaryFast needs digital pins 0-19");
+    static_assert((PinA < 8) == (PinB < 8) && (PinA < 14) == (PinB < 14), "RotaryFast pins must be on the same port");
+
+    unsigned char state;
+};
+
 #endif
 
 
@@ -0,0 +1,149 @@
+#include "Arduino.h"
+#include <util/atomic.h>
+
+#include "Skinny_ADC.h"
+#include "Skinny_Encoder.h"
+
+// These variables are shared with the ADC complete ISR
+// adcring[] holds the last ADC_RING samples, adchead is the next slot to write
+// adcacc is the window being accumulated and adcdone the last finished one.  adcready is set when adcdone is new
+volatile unsigned int adcring[ADC_RING];
+volatile unsigned char adchead;
+volatile Skinny_ADC_result_def adcacc, adcdone;
+volatile unsigned char adcready;
+volatile unsigned long adcsamples;
+volatile unsigned char adcdecimate, adcskip;
+// adcenv is the envelope in 1/65536 of an ADC count so small steps with long time constants are not lost
+volatile unsigned long adcenv;
+volatile unsigned char adcattack = 6, adcdecay = 12;
+
+ISR(ADC_vect)
+{
+  unsigned int sample = ADC;
+  unsigned long target;
+
+  if (adcskip) {
+    adcskip--;
+    return;
+  }
+  adcskip = adcdecimate;
+
+  adcring[adchead] = sample;
+  adchead = (adchead + 1) & (ADC_RING - 1);
+  adcsamples++;
+
+  // Envelope follower, see AdcEnvelope()
+  target = (unsigned long)sample << 16;
+  if (target > adcenv) {
+    adcenv += (target - adcenv) >> adcattack;
+  } else {
+    adcenv -= (adcenv - target) >> adcdecay;
+  }
+
+  if (sample > adcacc.peak) adcacc.peak = sample;
+  adcacc.sum += sample;
+  adcacc.sumsq += (unsigned long)sample * sample;
+
+  if (++adcacc.count >= ADC_WINDOW) {
+    adcdone.peak = adcacc.peak;
+    adcdone.count = adcacc.count;
+    adcdone.sum = adcacc.sum;
+    adcdone.sumsq = adcacc.sumsq;
+    adcready = 1;
+    adcacc.peak = adcacc.count = 0;
+    adcacc.sum = adcacc.sumsq = 0;
+  }
+}
+
+void AdcStart (unsigned char pin, unsigned char prescaler, unsigned char decimate)
+// Starts free running conversions on an analog pin (A0-A7 or 0-7) with AVcc reference as analogRead() uses.
+// decimate keeps 1 sample in decimate + 1.  analogRead() must not be used while this is running.
+{
+  if (pin >= A0) pin -= A0;
+
+  AdcStop ();
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    adchead = 0;
+    adcready = 0;
+    adcsamples = 0;
+    adcacc.peak = adcacc.count = 0;
+    adcacc.sum = adcacc.sumsq = 0;
+    adcdecimate = adcskip = decimate;
+  }
+
+  ADMUX = _BV(REFS0) | (pin & 0x07);
+  ADCSRB = 0;                                       // Free running trigger
+  ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | (prescaler & 0x07);
+  ADCSRA |= _BV(ADSC);                              // First conversion starts the chain
+}
+
+void AdcStop (void)
+{
+  ADCSRA &= ~(_BV(ADATE) | _BV(ADIE));
+}
+
+unsigned char AdcResult (Skinny_ADC_result_def *res)
+// Copies the last finished window into res.  Returns 1 if it has not been read before, 0 otherwise
+{
+  unsigned char fresh;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    res->peak = adcdone.peak;
+    res->count = adcdone.count;
+    res->sum = adcdone.sum;
+    res->sumsq = adcdone.sumsq;
+    fresh = adcready;
+    adcready = 0;
+  }
+  return fresh;
+}
+
+void AdcRestart (void)
+// Drops the window in progress and any unread result so the next result only has samples taken from now on
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    adcacc.peak = adcacc.count = 0;
+    adcacc.sum = adcacc.sumsq = 0;
+    adcready = 0;
+  }
+}
+
+unsigned char AdcHistory (unsigned int *buf, unsigned char count)
+// Copies the most recent samples, oldest first.  Returns the number copied
+{
+  unsigned char i, idx;
+
+  if (count > ADC_RING) count = ADC_RING;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    idx = adchead - count;
+    for (i = 0; i < count; i++, idx++) buf[i] = adcring[idx & (ADC_RING - 1)];
+  }
+  return count;
+}
+
+unsigned long AdcSamples (void)
+// Total samples taken since AdcStart()
+{
+  unsigned long n;
+
+  AtomicCopy (&n, &adcsamples, sizeof(n));
+  return n;
+}
+
+void AdcEnvelope (unsigned char attack, unsigned char decay)
+// Sets the envelope attack and decay as shift counts (time constant = 2^shift samples).  See Skinny_ADC.h
+{
+  if (attack > ADC_MAX_SHIFT) attack = ADC_MAX_SHIFT;
+  if (decay > ADC_MAX_SHIFT) decay = ADC_MAX_SHIFT;
+  adcattack = attack;
+  adcdecay = decay;
+}
+
+unsigned int AdcLevel (void)
+// Current envelope in ADC counts (rounded)
+{
+  unsigned long env;
+
+  AtomicCopy (&env, &adcenv, sizeof(env));
+  return (env + 0x8000) >> 16;
+}
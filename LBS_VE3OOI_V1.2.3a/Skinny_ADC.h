@@ -0,0 +1,43 @@
+#ifndef _SKINNY_ADC_H_
+#define _SKINNY_ADC_H_
+
+// Background ADC sampling.  The ADC runs in free running mode and the ADC complete interrupt
+// keeps the most recent samples in a ring and accumulates the peak, sum and sum of squares over
+// a window of ADC_WINDOW samples.  When a window is complete the result is published and the
+// next window starts, so loop() only ever reads a finished result and never waits for the ADC.
+//
+// Sample rate is F_CPU / prescaler / 13 (13 ADC clocks per conversion), divided by decimate.
+//   ADC_PS_128  9615 Hz at 16 MHz (most accurate, 10 bits)
+//   ADC_PS_64  19230 Hz
+//   ADC_PS_32  38461 Hz (about 8 bits of accuracy)
+
+#define ADC_RING   32           // Samples kept for AdcHistory().  Must be a power of 2
+#define ADC_WINDOW 100          // Samples per result.  Max 4104 so sumsq fits 32 bits
+
+// Envelope follower.  Each sample moves the envelope towards the sample by 1/2^attack of the difference
+// when rising and 1/2^decay when falling, so the time constant is 2^shift / sample rate.
+// At 9615 Hz: 4 = 1.7 ms, 6 = 6.7 ms, 8 = 27 ms, 10 = 107 ms, 12 = 426 ms, 14 = 1.7 s
+#define ADC_MAX_SHIFT 15
+
+#define ADC_PS_16  4            // ADPS bits
+#define ADC_PS_32  5
+#define ADC_PS_64  6
+#define ADC_PS_128 7
+
+typedef struct {
+  unsigned int peak;            // Highest sample in the window
+  unsigned int count;           // Samples in the window
+  unsigned long sum;            // For the mean (DC level)
+  unsigned long sumsq;          // For the mean square (power)
+} Skinny_ADC_result_def;
+
+void AdcStart (unsigned char pin, unsigned char prescaler, unsigned char decimate);
+void AdcStop (void);
+unsigned char AdcResult (Skinny_ADC_result_def *res);
+void AdcRestart (void);
+unsigned char AdcHistory (unsigned int *buf, unsigned char count);
+unsigned long AdcSamples (void);
+void AdcEnvelope (unsigned char attack, unsigned char decay);
+unsigned int AdcLevel (void);
+
+#endif // _SKINNY_ADC_H_
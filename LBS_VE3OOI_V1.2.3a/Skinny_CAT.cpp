@@ -0,0 +1,53 @@
+#include "Arduino.h"
+
+#include "Skinny_CAT.h"
+#include "Skinny_UART.h"
+#include "Skinny_TX.h"
+#include "LBS_VE3OOI_V1.3.h"
+
+// catbuff[] holds the bytes of a possible CAT command, catlen is how many.  catvalue and catdigits
+// accumulate the digits as they arrive so nothing has to be parsed when ';' arrives
+char catbuff[CAT_BUFF];
+unsigned char catlen, catdigits;
+unsigned long catvalue;
+
+void CatInput (char c)
+{
+  unsigned char i;
+
+  if (c == ';' && catlen >= 2) {
+    CatExecute (CAT_CMD (catbuff[0], catbuff[1]), catdigits, catvalue);
+    catlen = 0;
+    return;
+  }
+
+  // First two bytes must be upper case letters (and only at the start of a console line), then digits
+  if (catlen < 2 ? (isupper (c) && (catlen || ConsoleIdle ())) : (isdigit (c) && catlen < CAT_BUFF - 1)) {
+    if (!catlen) catvalue = catdigits = 0;
+    if (catlen >= 2) {
+      catvalue = catvalue * 10 + (c - '0');
+      catdigits++;
+    }
+    catbuff[catlen++] = c;
+    return;
+  }
+
+  // Not CAT.  Hand over what was held back and this byte to the console
+  for (i = 0; i < catlen; i++) ConsoleInput (catbuff[i]);
+  catlen = 0;
+  ConsoleInput (c);
+}
+
+void CatReply (unsigned int cmd, unsigned long value, unsigned char digits)
+// Answers a get command, e.g. CatReply (CAT_CMD('M', 'D'), 2, 1) sends MD2;
+{
+  TxChar ((char)(cmd >> 8));
+  TxChar ((char)(cmd & 0xFF));
+  TxDigits (value, digits);
+  TxChar (';');
+}
+
+void CatError (void)
+{
+  TxFlash (PSTR ("?;"));
+}
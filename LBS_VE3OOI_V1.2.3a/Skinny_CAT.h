@@ -0,0 +1,26 @@
+#ifndef _SKINNY_CAT_H_
+#define _SKINNY_CAT_H_
+
+// Computer control (CAT) using a subset of the Kenwood TS-480 commands so logging and digital mode
+// programs can use the radio as a TS-480.  Commands are two upper case letters, optional digits and ';'
+//   FA;  FAnnnnnnnnnnn;   Get/set the dial frequency in Hz (11 digits)
+//   MD;  MDn;             Get/set the mode, 1 = LSB, 2 = USB
+//   SM;  SM0;             Get the S meter, SM0nnnn; with nnnn 0000 to 0030
+//   ST;  STnnnnnnn;       Get/set the tuning step in Hz (10 to 1000000, not a TS-480 command)
+//   IF;                   Get the status (frequency and mode)
+//   ID;  PS;  AI;  AIn;   Fixed answers so programs detect the radio
+// A set command has no answer.  An unknown or bad command answers "?;".
+//
+// CAT shares the serial port with the console.  CatInput() takes one byte at a time.  Upper case letters
+// at the start of a console line and the digits after them are held back until ';' arrives (CAT) or a
+// byte that cannot be CAT arrives, in which case the held bytes go to the console as if just typed.
+// Nothing is echoed for CAT so each byte costs a few comparisons and the command runs on ';'.
+
+#define CAT_BUFF 14             // Longest command is FAnnnnnnnnnnn;
+#define CAT_CMD(a, b) (((unsigned int)(a) << 8) | (b))
+
+void CatInput (char c);
+void CatReply (unsigned int cmd, unsigned long value, unsigned char digits);
+void CatError (void);
+
+#endif // _SKINNY_CAT_H_
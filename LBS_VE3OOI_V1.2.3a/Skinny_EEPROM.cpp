@@ -0,0 +1,236 @@
+#include "Arduino.h"
+#include <EEPROM.h>
+#include <util/atomic.h>
+
+#include "Skinny_EEPROM.h"
+
+// These variables are shared with the EEPROM ready ISR
+// eequeue[] holds the bytes to program, eehead is only written by EEWrite() and eetail only by the ISR.
+// Both count up and wrap at 256 and are masked to index eequeue[] so all EE_QUEUE entries can be used
+typedef struct {
+  unsigned int addr;
+  unsigned char value;
+} Skinny_EEPROM_byte_def;
+
+volatile Skinny_EEPROM_byte_def eequeue[EE_QUEUE];
+volatile unsigned char eehead, eetail;
+
+// eeslot is the slot holding the newest valid record (EE_NO_SLOT if none) and eeseq its sequence number
+// eescanned is set once the journal has been scanned for the current record length
+unsigned char eeslot = EE_NO_SLOT;
+unsigned int eeseq;
+unsigned char eescanned;
+
+unsigned int EECRC16 (unsigned int crc, unsigned char data)
+// CRC-CCITT (polynomial 0x1021), same as _crc_ccitt_update() in avr-libc
+{
+  data ^= crc & 0xFF;
+  data ^= data << 4;
+  return ((((unsigned int)data << 8) | (crc >> 8)) ^ (unsigned char)(data >> 4) ^ ((unsigned int)data << 3));
+}
+
+ISR(EE_READY_vect)
+// Runs whenever the EEPROM is idle and EERIE is set.  Starts programming the next byte or turns itself off.
+// A byte the EEPROM already holds is dropped.  The interrupt fires again straight away for the one after it
+{
+  unsigned char tail = eetail;
+  volatile Skinny_EEPROM_byte_def *next;
+
+  if (tail == eehead) {
+    EECR &= ~_BV(EERIE);
+    return;
+  }
+
+  next = &eequeue[tail & EE_QUEUE_MASK];
+  eetail = tail + 1;
+  EEAR = next->addr;
+  EECR |= _BV(EERE);
+  if (EEDR == next->value) return;
+
+  EEDR = next->value;
+  EECR |= _BV(EEMPE);                   // EEPE must be set within 4 cycles of EEMPE
+  EECR |= _BV(EEPE);
+}
+
+static void EEQueue (unsigned int addr, unsigned char value)
+// Queues a byte to program.  Waits only if the queue is full
+{
+  unsigned char head = eehead;
+
+  while ((unsigned char)(head - eetail) >= EE_QUEUE) delay (1);
+
+  eequeue[head & EE_QUEUE_MASK].addr = addr;
+  eequeue[head & EE_QUEUE_MASK].value = value;
+  eehead = head + 1;                       // Publish after the entry is written
+  EECR |= _BV(EERIE);
+}
+
+static unsigned char EEQueued (unsigned int addr, unsigned char *value)
+// Newest queued value for addr.  Returns 0 if it is not queued.  Needs no atomic block: only the caller adds entries
+// and an entry the ISR takes while this runs still holds the value the EEPROM ends up with
+{
+  unsigned char i;
+
+  for (i = eehead; i != eetail; ) {
+    i--;
+    if (eequeue[i & EE_QUEUE_MASK].addr == addr) {
+      *value = eequeue[i & EE_QUEUE_MASK].value;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static unsigned char EEPeek (unsigned int addr, unsigned char *value)
+// Like EERead() but never waits.  Returns 0 if the byte is not queued and the EEPROM is busy programming another
+{
+  unsigned char found = 0;
+
+  if (EEQueued (addr, value)) return 1;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (!(EECR & _BV(EEPE))) {
+      EEAR = addr;
+      EECR |= _BV(EERE);
+      *value = EEDR;
+      found = 1;
+    }
+  }
+  return found;
+}
+
+void EEWrite (unsigned int addr, unsigned char value)
+// Queues a byte unless the queue already holds that value for it.  Bytes the EEPROM holds are dropped by the ISR
+{
+  unsigned char queued;
+
+  if (!EEQueued (addr, &queued) || queued != value) EEQueue (addr, value);
+}
+
+unsigned char EERead (unsigned int addr)
+// Reads a byte, taking the newest queued value for the address if there is one.
+// The EEPROM cannot be read while a byte is being programmed (up to 3.4 ms).  The ISR is held off so no other
+// byte starts and that one is waited for with interrupts on
+{
+  unsigned char value;
+
+  if (EEPeek (addr, &value)) return value;
+
+  EECR &= ~_BV(EERIE);
+  while (!EEPeek (addr, &value)) {
+    while (EECR & _BV(EEPE));
+  }
+  if (eehead != eetail) EECR |= _BV(EERIE);
+  return value;
+}
+
+unsigned char EEPending (void)
+// Bytes queued or being programmed.  Queued bytes the EEPROM already holds are counted until the ISR drops them
+{
+  return (unsigned char)(eehead - eetail) + ((EECR & _BV(EEPE)) ? 1 : 0);
+}
+
+void EEFlush (void)
+// Waits until all queued bytes are in the EEPROM.  Use before a reset or power down
+{
+  while (EEPending ()) delay (1);
+}
+
+static unsigned char EEJournalSlots (unsigned char len)
+{
+  return (EE_JOURNAL_END - EE_JOURNAL_START) / (len + 4);
+}
+
+static void EEJournalScan (unsigned char len)
+// One pass over all slots to find the newest record with a good CRC.  Sequence numbers are compared
+// with wrap around so the journal keeps working after 65535 saves.
+{
+  unsigned char slot, i;
+  unsigned int addr, seq, crc;
+
+  eeslot = EE_NO_SLOT;
+  for (slot = 0; slot < EEJournalSlots (len); slot++) {
+    addr = EE_JOURNAL_START + slot * (len + 4);
+    seq = EERead (addr) | (EERead (addr + 1) << 8);
+    if (seq == EE_ERASED_SEQ) continue;
+
+    crc = 0xFFFF;
+    for (i = 0; i < len + 2; i++) crc = EECRC16 (crc, EERead (addr + i));
+    if (crc != (unsigned int)(EERead (addr + len + 2) | (EERead (addr + len + 3) << 8))) continue;
+
+    if (eeslot == EE_NO_SLOT || (int16_t)(seq - eeseq) > 0) {
+      eeslot = slot;
+      eeseq = seq;
+    }
+  }
+  eescanned = 1;
+}
+
+unsigned char EEJournalLoad (void *data, unsigned char len)
+// Copies the newest record into data.  Returns 0 (data untouched) if there is no valid record
+{
+  unsigned char i, *ptr = (unsigned char *)data;
+  unsigned int addr;
+
+  EEJournalScan (len);
+  if (eeslot == EE_NO_SLOT) return 0;
+
+  addr = EE_JOURNAL_START + eeslot * (len + 4) + 2;
+  for (i = 0; i < len; i++) ptr[i] = EERead (addr + i);
+  return 1;
+}
+
+static unsigned char EERecordByte (unsigned char *data, unsigned char len, unsigned int seq, unsigned int crc, unsigned char i)
+// Byte i of a record: sequence number, settings, CRC
+{
+  if (i < 2) return i ? seq >> 8 : seq & 0xFF;
+  if (i < len + 2) return data[i - 2];
+  return (i == len + 2) ? crc & 0xFF : crc >> 8;
+}
+
+unsigned char EEJournalSave (void *data, unsigned char len)
+// Appends data as a new record.  Returns 0 if nothing needed to be written (or len is over EE_RECORD_MAX)
+{
+  unsigned char i, j, slot, *ptr = (unsigned char *)data;
+  unsigned int addr, seq, crc;
+
+  if (len > EE_RECORD_MAX) return 0;
+  if (!eescanned) EEJournalScan (len);
+
+  // Nothing to do if the newest record already holds these settings.  A byte that cannot be read without waiting
+  // for the EEPROM is taken as changed, which at worst writes an unchanged record
+  if (eeslot != EE_NO_SLOT) {
+    addr = EE_JOURNAL_START + eeslot * (len + 4) + 2;
+    for (i = 0; i < len && EEPeek (addr + i, &j) && j == ptr[i]; i++);
+    if (i == len) return 0;
+  }
+
+  slot = (eeslot == EE_NO_SLOT) ? 0 : eeslot + 1;
+  if (slot >= EEJournalSlots (len)) slot = 0;
+  seq = (eeslot == EE_NO_SLOT) ? 0 : (eeseq + 1) & 0xFFFF;
+  if (seq == EE_ERASED_SEQ) seq = 0;
+
+  crc = EECRC16 (EECRC16 (0xFFFF, seq & 0xFF), seq >> 8);
+  for (i = 0; i < len; i++) crc = EECRC16 (crc, ptr[i]);
+
+  // Settings first, then the CRC, then the sequence number.  Until the CRC matches the slot is ignored.
+  // The whole record is queued.  The ISR only programs the bytes the slot does not already hold
+  addr = EE_JOURNAL_START + slot * (len + 4);
+  for (j = 0; j < len + 4; j++) {
+    i = (j + 2) % (len + 4);
+    EEWrite (addr + i, EERecordByte (ptr, len, seq, crc, i));
+  }
+
+  eeslot = slot;
+  eeseq = seq;
+  return 1;
+}
+
+unsigned char EEJournalSlot (void)
+{
+  return eeslot;
+}
+
+unsigned int EEJournalSeq (void)
+{
+  return eeseq;
+}
@@ -0,0 +1,39 @@
+#ifndef _SKINNY_EEPROM_H_
+#define _SKINNY_EEPROM_H_
+
+// Settings journal.  The upper half of the EEPROM is split into slots and each save goes to the slot after
+// the newest one so the writes are spread over all slots.  A slot holds
+//   sequence number (2 bytes), the settings (len bytes), CRC16 of sequence and settings (2 bytes)
+// Bytes go through EEWrite() so only bytes that differ from what the slot held are programmed,
+// and a save is skipped entirely if the settings match the newest record.
+// A slot with a bad CRC (e.g. power lost during a save) is ignored and the previous record is used.
+
+// Write queue.  EEWrite() queues a byte and returns at once; the EEPROM ready interrupt programs the queued
+// bytes one at a time (about 3.4 ms each) so loop() never waits for the EEPROM.  The EEPROM cannot be read while
+// a byte is being programmed so EEWrite() does not read it.  The interrupt compares each byte with the EEPROM
+// when it gets to it and drops the ones that did not change.  The queue holds a whole journal record so a save
+// only waits if the one before it is still being programmed.
+// EERead() sees bytes that are still queued.  For a byte not in the queue it waits (with interrupts on) for the
+// byte being programmed, if any.  EEFlush() waits until everything is programmed.
+
+#define EE_QUEUE 64             // Bytes waiting to be programmed.  Must be a power of 2 and no more than 128
+#define EE_QUEUE_MASK (EE_QUEUE - 1)
+
+#define EE_JOURNAL_START 512        // Messages (UPDATE_EEPROM) and the old settings use 0 to 511
+#define EE_JOURNAL_END   1024       // ATmega328 has 1 KB
+#define EE_RECORD_MAX    (EE_QUEUE - 4)   // Largest settings record EEJournalSave() takes.  With its header it fills the queue
+#define EE_NO_SLOT       0xFF
+#define EE_ERASED_SEQ    0xFFFF     // Never used so an erased slot is never taken as a record
+
+void EEWrite (unsigned int addr, unsigned char value);
+unsigned char EERead (unsigned int addr);
+unsigned char EEPending (void);
+void EEFlush (void);
+
+unsigned char EEJournalLoad (void *data, unsigned char len);
+unsigned char EEJournalSave (void *data, unsigned char len);
+unsigned char EEJournalSlot (void);
+unsigned int EEJournalSeq (void);
+unsigned int EECRC16 (unsigned int crc, unsigned char data);
+
+#endif // _SKINNY_EEPROM_H_
@@ -0,0 +1,79 @@
+#include "Arduino.h"
+#include <util/atomic.h>
+
+#include "Skinny_Encoder.h"
+
+// These variables are shared between the pin change ISR and loop()
+// encqueue[] holds one signed step per detent (+1 CW, -1 CCW)
+// enchead is only written by the ISR and enctail only by loop()
+// encspill collects steps that arrive while the queue is full.  It is a 16 bit value so loop() reads it with interrupts off.
+volatile signed char encqueue[ENC_QUEUE];
+volatile unsigned char enchead, enctail;
+volatile int encspill;
+volatile Skinny_Encoder_stats_def encstats;
+
+void EncoderPush (signed char step)
+// Called from the ISR only.  When the queue is full the step is added to encspill so a long blocked loop() does not lose detents
+{
+  unsigned char head = enchead, depth;
+
+  depth = (unsigned char)(head - enctail) & (2 * ENC_QUEUE - 1);
+  if (depth >= ENC_QUEUE) {
+    encspill += step;
+    encstats.overflows++;
+    return;
+  }
+
+  encqueue[head & ENC_QUEUE_MASK] = step;
+  enchead = (head + 1) & (2 * ENC_QUEUE - 1);    // Publish after the slot is written
+
+  if (++depth > encstats.maxdepth) encstats.maxdepth = depth;
+}
+
+int EncoderDrain (void)
+// Called from loop() only.  Returns the sum of all steps queued since the last call (0 if the knob has not moved)
+{
+  unsigned char tail = enctail, head = enchead;
+  int steps = 0;
+
+  while (tail != head) {
+    steps += encqueue[tail & ENC_QUEUE_MASK];
+    tail = (tail + 1) & (2 * ENC_QUEUE - 1);
+  }
+  enctail = tail;                                 // Free the slots after they are read
+
+  if (encspill) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      steps += encspill;
+      encspill = 0;
+    }
+  }
+  return steps;
+}
+
+void EncoderReset (void)
+// Drops anything queued and clears the statistics
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    enctail = enchead;
+    encspill = 0;
+    encstats.overflows = 0;
+    encstats.maxdepth = 0;
+  }
+}
+
+void EncoderStats (Skinny_Encoder_stats_def *stats)
+{
+  AtomicCopy (stats, &encstats, sizeof(encstats));
+}
+
+void AtomicCopy (void *dst, const volatile void *src, unsigned char len)
+// Takes a consistent snapshot of data shared with an ISR.  Anything wider than one byte can be torn on the AVR otherwise
+{
+  unsigned char *d = (unsigned char *)dst;
+  const volatile unsigned char *s = (const volatile unsigned char *)src;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    while (len--) *d++ = *s++;
+  }
+}
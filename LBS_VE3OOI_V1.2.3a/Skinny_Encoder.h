@@ -0,0 +1,22 @@
+#ifndef _ENCODER_H_
+#define _ENCODER_H_
+
+// Single producer (pin change ISR) / single consumer (loop) queue of encoder steps.
+// The ISR only writes enchead and the loop only writes enctail so no locking is needed for the queue itself.
+// Both indexes are one byte so they are read and written atomically on the AVR.
+
+#define ENC_QUEUE 16            // Must be a power of 2 and no more than 128
+#define ENC_QUEUE_MASK (ENC_QUEUE - 1)
+
+typedef struct {
+  unsigned int overflows;       // Steps that arrived while the queue was full (they are kept in the spill count, not lost)
+  unsigned char maxdepth;       // Deepest the queue has been since the last reset
+} Skinny_Encoder_stats_def;
+
+void EncoderPush (signed char step);
+int EncoderDrain (void);
+void EncoderReset (void);
+void EncoderStats (Skinny_Encoder_stats_def *stats);
+void AtomicCopy (void *dst, const volatile void *src, unsigned char len);
+
+#endif // _ENCODER_H_
@@ -0,0 +1,111 @@
+#include "Arduino.h"
+
+#include "Skinny_Mem.h"
+
+#ifdef __AVR__
+extern char __heap_start, *__brkval;      // avr-libc malloc().  __brkval is 0 until the first malloc()
+#else
+unsigned char *membottom;                 // Host build, MEM_HOST_RAM below the stack at MemInit()
+#endif
+
+// memstart is the stack pointer at MemInit() and memlowest the lowest byte the stack is known to have reached.
+// memsitesp is the stack pointer at MemSiteBegin()
+unsigned char *memstart, *memlowest, *memsitesp;
+unsigned int memheap;
+unsigned int memsite[MEM_SITE_COUNT];
+
+static unsigned char *MemBottom (void)
+// Lowest address the stack can grow down to, the top of the heap
+{
+#ifdef __AVR__
+  return (unsigned char *)(__brkval ? __brkval : &__heap_start);
+#else
+  return membottom;
+#endif
+}
+
+static unsigned char * __attribute__ ((noinline)) MemStackPointer (void)
+{
+#ifdef __AVR__
+  return (unsigned char *)SP;
+#else
+  return (unsigned char *)__builtin_frame_address (0);
+#endif
+}
+
+static void MemPaint (void)
+// Fills the free RAM below the stack with MEM_PAINT
+{
+  unsigned char *p, *top;
+
+  top = MemStackPointer () - MEM_GUARD;
+  for (p = MemBottom (); p < top; p++) *(volatile unsigned char *)p = MEM_PAINT;
+}
+
+static unsigned char *MemScan (void)
+// Returns the lowest byte the stack has written since the last paint and updates memlowest and memheap
+{
+  unsigned char *p, *top;
+
+  top = MemStackPointer ();
+  for (p = MemBottom (); p < top && *(volatile unsigned char *)p == MEM_PAINT; p++);
+  if (p < memlowest) memlowest = p;
+
+#ifdef __AVR__
+  if (__brkval && (unsigned int)(__brkval - &__heap_start) > memheap) memheap = __brkval - &__heap_start;
+#endif
+  return p;
+}
+
+void MemInit (void)
+// Call first in setup().  Everything below setup() is measured from here on
+{
+#ifndef __AVR__
+  membottom = MemStackPointer () - MEM_HOST_RAM;
+#endif
+  memstart = MemStackPointer ();
+  MemReset ();
+}
+
+void MemReset (void)
+// Repaints the free RAM and clears the high water marks
+{
+  unsigned char i;
+
+  MemPaint ();
+  memlowest = MemStackPointer () - MEM_GUARD;
+  memheap = 0;
+  for (i = 0; i < MEM_SITE_COUNT; i++) memsite[i] = 0;
+}
+
+void MemStats (Skinny_Mem_stats_def *stats)
+{
+  unsigned char *bottom;
+
+  MemScan ();
+  bottom = MemBottom ();
+  stats->free = MemStackPointer () - bottom;
+  stats->minfree = memlowest > bottom ? memlowest - bottom : 0;
+  stats->stack = memstart - memlowest;
+  stats->heap = memheap;
+  memcpy (stats->site, memsite, sizeof(memsite));
+}
+
+void MemSiteBegin (void)
+// Call just before the call to measure.  The repaint below would wipe the high water mark so it is taken first
+{
+  MemScan ();
+  memsitesp = MemStackPointer ();
+  MemPaint ();
+}
+
+void MemSiteEnd (unsigned char site)
+// Call just after.  Records the deepest the call went below the caller for site (MEM_SITE_xxx)
+{
+  unsigned char *p;
+
+  p = MemScan ();
+  if (site < MEM_SITE_COUNT && p < memsitesp && (unsigned int)(memsitesp - p) > memsite[site]) {
+    memsite[site] = memsitesp - p;
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef _SKINNY_MEM_H_
+#define _SKINNY_MEM_H_
+
+// RAM use.  The free RAM between the top of the heap and the stack is filled with MEM_PAINT by MemInit().
+// The stack grows down into it so the lowest byte that no longer holds MEM_PAINT is the deepest the stack
+// has been (high water mark).  Interrupts are included as they run on the same stack.
+//
+// With MEM_SITES set, MEM_SITE_BEGIN()/MEM_SITE_END() around a call repaint the free RAM and then measure
+// how deep that call went.  Each repaint writes all of the free RAM (about 0.2 ms on the ATmega328) so it is off by default.
+
+#ifndef MEM_SITES
+#define MEM_SITES     0             // 1 to measure the stack depth of the call sites below
+#endif
+
+#define MEM_PAINT     0xC5
+#define MEM_GUARD     16            // Bytes below the stack pointer left alone when painting
+#define MEM_HOST_RAM  8192          // Host build only.  Free RAM simulated below the stack at MemInit()
+
+#define MEM_SITE_TUNE     0         // SetFrequency() calls in loop()
+#define MEM_SITE_CONSOLE  1         // ExecuteSerial()
+#define MEM_SITE_COUNT    2
+
+typedef struct {
+  unsigned int free;                // Now, between the heap and the stack
+  unsigned int minfree;             // Least there has been since MemInit() or MemReset()
+  unsigned int stack;               // Deepest the stack has been below the stack pointer at MemInit()
+  unsigned int heap;                // Largest the heap has been (0 unless something calls malloc())
+  unsigned int site[MEM_SITE_COUNT];  // Deepest each call site went, below the caller (0 without MEM_SITES)
+} Skinny_Mem_stats_def;
+
+void MemInit (void);
+void MemReset (void);
+void MemStats (Skinny_Mem_stats_def *stats);
+void MemSiteBegin (void);
+void MemSiteEnd (unsigned char site);
+
+#if MEM_SITES
+#define MEM_SITE_BEGIN()    MemSiteBegin ()
+#define MEM_SITE_END(site)  MemSiteEnd (site)
+#else
+#define MEM_SITE_BEGIN()
+#define MEM_SITE_END(site)
+#endif
+
+#endif // _SKINNY_MEM_H_
@@ -0,0 +1,92 @@
+#include "Arduino.h"
+
+#include "Skinny_PCD8544.h"
+
+Skinny_PCD8544::Skinny_PCD8544 (int8_t SCLK, int8_t DIN, int8_t DC, int8_t CS, int8_t RST) :
+  Adafruit_PCD8544 (SCLK, DIN, DC, CS, RST)
+{
+  // The library buffer starts with the splash screen so all of it has to go out once
+  invalidate ();
+}
+
+void Skinny_PCD8544::drawPixel (int16_t x, int16_t y, uint16_t color)
+// Same as the library but only marks the bank dirty if the byte actually changes
+{
+  unsigned char bank, old, *ptr;
+
+  if ((x < 0) || (x >= LCDWIDTH) || (y < 0) || (y >= LCDHEIGHT)) return;
+
+  bank = y >> 3;
+  ptr = &pcd8544_buffer[x + bank * LCDWIDTH];
+  old = *ptr;
+  if (color) {
+    *ptr |= _BV(y & 7);
+  } else {
+    *ptr &= ~_BV(y & 7);
+  }
+  if (*ptr == old) return;
+
+  if (x < xmin[bank]) xmin[bank] = x;
+  if (x > xmax[bank]) xmax[bank] = x;
+}
+
+void Skinny_PCD8544::clearDisplay (void)
+{
+  unsigned char bank, x, *ptr;
+
+  // Only the columns that had something on them need to be sent
+  ptr = pcd8544_buffer;
+  for (bank = 0; bank < PCD8544_BANKS; bank++) {
+    for (x = 0; x < LCDWIDTH; x++, ptr++) {
+      if (!*ptr) continue;
+      *ptr = 0;
+      if (x < xmin[bank]) xmin[bank] = x;
+      if (x > xmax[bank]) xmax[bank] = x;
+    }
+  }
+  cursor_x = cursor_y = 0;
+}
+
+void Skinny_PCD8544::display (void)
+{
+  flush ();
+}
+
+void Skinny_PCD8544::flush (void)
+// Each dirty range needs 2 address commands and then the data bytes.  The controller auto increments the column.
+{
+  unsigned char bank, x;
+  uint8_t *ptr;
+
+  for (bank = 0; bank < PCD8544_BANKS; bank++) {
+    if (xmin[bank] > xmax[bank]) continue;
+
+    command (PCD8544_SETYADDR | bank);
+    command (PCD8544_SETXADDR | xmin[bank]);
+    ptr = &pcd8544_buffer[bank * LCDWIDTH + xmin[bank]];
+    for (x = xmin[bank]; x <= xmax[bank]; x++) data (*ptr++);
+
+    xmin[bank] = LCDWIDTH;
+    xmax[bank] = 0;
+  }
+}
+
+void Skinny_PCD8544::invalidate (void)
+{
+  unsigned char bank;
+
+  for (bank = 0; bank < PCD8544_BANKS; bank++) {
+    xmin[bank] = 0;
+    xmax[bank] = LCDWIDTH - 1;
+  }
+}
+
+unsigned char Skinny_PCD8544::dirty (void)
+{
+  unsigned char bank;
+
+  for (bank = 0; bank < PCD8544_BANKS; bank++) {
+    if (xmin[bank] <= xmax[bank]) return 1;
+  }
+  return 0;
+}
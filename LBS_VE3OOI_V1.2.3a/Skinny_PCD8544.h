@@ -0,0 +1,34 @@
+#ifndef _SKINNY_PCD8544_H_
+#define _SKINNY_PCD8544_H_
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_PCD8544.h>
+
+// Adafruit_PCD8544 with dirty tracking.  The controller memory is 6 banks of 8 pixel rows by 84 columns.
+// For each bank we keep the first and last column whose byte changed since the last flush() and only
+// those bytes are sent.  A pixel drawn with the colour it already has does not mark anything, so
+// redrawing the same text every loop() costs no SPI traffic.
+// Rotation is not supported (the LBS display is not rotated).
+
+#define PCD8544_BANKS (LCDHEIGHT / 8)
+
+// Frame buffer in the Adafruit library (Adafruit_PCD8544.cpp)
+extern uint8_t pcd8544_buffer[];
+
+class Skinny_PCD8544 : public Adafruit_PCD8544 {
+  public:
+    Skinny_PCD8544 (int8_t SCLK, int8_t DIN, int8_t DC, int8_t CS, int8_t RST);
+
+    void drawPixel (int16_t x, int16_t y, uint16_t color);
+    void clearDisplay (void);
+    void display (void);                // Same as flush() so existing callers only send what changed
+    void flush (void);                  // Send dirty columns of each bank to the controller
+    void invalidate (void);             // Mark the whole screen dirty.  Use after begin() or a controller reset
+    unsigned char dirty (void);         // Non zero if a flush() would send anything
+
+  private:
+    unsigned char xmin[PCD8544_BANKS];  // First dirty column, LCDWIDTH if the bank is clean
+    unsigned char xmax[PCD8544_BANKS];  // Last dirty column
+};
+
+#endif // _SKINNY_PCD8544_H_
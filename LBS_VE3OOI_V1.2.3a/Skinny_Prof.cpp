@@ -0,0 +1,76 @@
+#include "Arduino.h"
+#include <util/atomic.h>
+
+#include "Skinny_Prof.h"
+#include "Skinny_Encoder.h"
+
+// PROF_ISR is written by the encoder ISR so it is read and cleared with interrupts off.  The other stages are loop() only.
+// profdetent is micros() of the first detent not yet retuned for, 0 if none
+volatile Skinny_Prof_stats_def profstats[PROF_STAGES];
+volatile unsigned long profdetent;
+
+const char profnames[PROF_STAGES][8] PROGMEM = {
+  "Serial", "Sweep", "Tune", "Smeter", "Buttons", "Render", "Save", "Loop", "ISR", "Detent"};
+
+void ProfAdd (unsigned char stage, unsigned long us)
+// Adds one timing to stage.  Call with interrupts off for PROF_ISR (i.e. from the ISR)
+{
+  volatile Skinny_Prof_stats_def *p = &profstats[stage];
+  unsigned int t = us > 0xFFFF ? 0xFFFF : us;
+  unsigned char b;
+
+  if (!p->count || t < p->min) p->min = t;
+  if (t > p->max) p->max = t;
+  p->count++;
+  p->total += us;
+
+  // 64 us then x4 per bucket
+  for (b = 0, us >>= 6; us && b < PROF_BUCKETS - 1; b++) us >>= 2;
+  if (p->hist[b] != 0xFFFF) p->hist[b]++;
+}
+
+unsigned long ProfMark (unsigned char stage, unsigned long since)
+// Adds the time from since to now to stage and returns now for the next stage
+{
+  unsigned long now = micros ();
+
+  ProfAdd (stage, now - since);
+  return now;
+}
+
+void ProfDetent (void)
+// Called from the encoder ISR for every step queued.  Only the first one before a retune counts
+{
+  if (!profdetent) profdetent = micros () | 1;
+}
+
+unsigned long ProfDetentTake (void)
+// Returns micros() of the first detent since the last call (0 if none) and clears it
+{
+  unsigned long t;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    t = profdetent;
+    profdetent = 0;
+  }
+  return t;
+}
+
+void ProfReset (void)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    memset ((void *)profstats, 0, sizeof(profstats));
+    profdetent = 0;
+  }
+}
+
+void ProfStats (unsigned char stage, Skinny_Prof_stats_def *stats)
+{
+  AtomicCopy (stats, &profstats[stage], sizeof(*stats));
+}
+
+const char *ProfName (unsigned char stage)
+// Stage name in flash
+{
+  return profnames[stage];
+}
@@ -0,0 +1,60 @@
+#ifndef _SKINNY_PROF_H_
+#define _SKINNY_PROF_H_
+
+// Main loop profiler.  Each task run by the scheduler (Skinny_Sched.h) is a stage.  It is timed with micros()
+// (4 us resolution on the ATmega328) and the count, min, max, total and a coarse histogram are kept per stage.
+// A whole pass of loop() and the encoder ISR are timed the same way.
+// PROF_DETENT is the time from the first detent the ISR queued to the end of the I2C writes that retuned for it.
+// Set PROF_ENABLE to 0 to compile it all out.  Each stage costs one micros() call (about 4 us).
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE   1
+#endif
+
+#define PROF_SERIAL   0             // ProcessSerial() and TxPump()
+#define PROF_SWEEP    1             // Scanner or bandscope
+#define PROF_TUNE     2             // Encoder steps, LSB/USB switch and SetFrequency()
+#define PROF_SMETER   3             // readSmeter()
+#define PROF_BUTTONS  4             // Tune and encoder buttons
+#define PROF_RENDER   5             // RenderScreen()
+#define PROF_SAVE     6             // Settings save
+#define PROF_LOOP     7             // Whole pass of loop()
+#define PROF_ISR      8             // Encoder pin change ISR
+#define PROF_DETENT   9             // Detent to retune complete
+#define PROF_STAGES   10
+
+#define PROF_BUCKETS  5             // Histogram: < 64 us, < 256 us, < 1 ms, < 4 ms, longer
+
+typedef struct {
+  unsigned long count;
+  unsigned long total;              // us
+  unsigned int min, max;            // us, 65535 for longer
+  unsigned int hist[PROF_BUCKETS];  // Stop at 65535
+} Skinny_Prof_stats_def;
+
+void ProfAdd (unsigned char stage, unsigned long us);
+unsigned long ProfMark (unsigned char stage, unsigned long since);
+void ProfDetent (void);
+unsigned long ProfDetentTake (void);
+void ProfReset (void);
+void ProfStats (unsigned char stage, Skinny_Prof_stats_def *stats);
+const char *ProfName (unsigned char stage);
+
+// Timestamps for the macros are declared with PROF_VAR() so they go away with PROF_ENABLE 0
+#if PROF_ENABLE
+#define PROF_VAR(t)         unsigned long t
+#define PROF_BEGIN(t)       t = micros ()
+#define PROF_STAGE(t, s)    t = ProfMark (s, t)
+#define PROF_DETENT_MARK()  ProfDetent ()
+#define PROF_DETENT_TAKE(t) t = ProfDetentTake ()
+#define PROF_DETENT_DONE(t) do { if (t) ProfAdd (PROF_DETENT, micros () - t); } while (0)
+#else
+#define PROF_VAR(t)
+#define PROF_BEGIN(t)
+#define PROF_STAGE(t, s)
+#define PROF_DETENT_MARK()
+#define PROF_DETENT_TAKE(t)
+#define PROF_DETENT_DONE(t)
+#endif
+
+#endif // _SKINNY_PROF_H_
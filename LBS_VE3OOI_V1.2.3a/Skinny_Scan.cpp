@@ -0,0 +1,197 @@
+#include "Arduino.h"
+
+#include "Skinny_Scan.h"
+#include "Skinny_ADC.h"
+#include "Skinny_EEPROM.h"
+#include "LBS_VE3OOI_V1.3.h"
+
+// scanfreq is the dial frequency being measured, scanch the memory channel it came from.
+// scantime is when the current state started.  Only loop() uses these
+unsigned char scanmode, scanstate, scanch;
+unsigned long scanstart, scanstop, scanstep, scanfreq, scantime, scanmoving;
+unsigned char scansettle = SCAN_SETTLE, scanthreshold = SCAN_THRESHOLD;
+unsigned int scanhang = SCAN_HANG;
+Skinny_Scan_stats_def scanstats;
+
+static void ScanBegin (unsigned char mode)
+{
+  scanmode = mode;
+  scanstate = SCAN_TUNE;
+  scanch = SCAN_CHANNELS - 1;         // First channel tried is 0
+  memset (&scanstats, 0, sizeof(scanstats));
+  scanmoving = millis ();
+}
+
+void ScanRange (unsigned long start, unsigned long stop, unsigned long step)
+// Scans start to stop (dial Hz) in steps of step, then starts again at start
+{
+  scanstart = scanfreq = start;
+  scanstop = stop;
+  scanstep = step;
+  scanfreq -= step;                   // First channel tried is start
+  ScanBegin (SCAN_RANGE);
+}
+
+static unsigned char ScanInLimits (unsigned long freq, unsigned long low, unsigned long high)
+{
+  return freq > low && freq < high;
+}
+
+unsigned char ScanMemory (unsigned long low, unsigned long high)
+// Scans the memory channels that are set and above low and below high (dial Hz).  Returns 0 if there are none
+{
+  unsigned char ch;
+
+  for (ch = 0; ch < SCAN_CHANNELS && !ScanInLimits (ScanChannelRead (ch), low, high); ch++);
+  if (ch == SCAN_CHANNELS) return 0;
+  ScanBegin (SCAN_MEMORY);
+  return 1;
+}
+
+void ScanStop (void)
+{
+  if (scanmode != SCAN_OFF && scanstate != SCAN_HOLD) scanstats.elapsed += millis () - scanmoving;
+  scanmode = SCAN_OFF;
+}
+
+unsigned char ScanActive (void)
+{
+  return scanmode != SCAN_OFF;
+}
+
+void ScanSettings (unsigned char settle, unsigned int hang, unsigned char threshold)
+{
+  scansettle = settle;
+  scanhang = hang;
+  scanthreshold = threshold;
+}
+
+unsigned char ScanLevel (void)
+// Last level measured in S meter bar pixels
+{
+  return scanstats.level;
+}
+
+void ScanStats (Skinny_Scan_stats_def *stats)
+// elapsed includes the channel in progress so channels / elapsed is the rate while scanning
+{
+  *stats = scanstats;
+  if (scanmode != SCAN_OFF && scanstate != SCAN_HOLD) stats->elapsed += millis () - scanmoving;
+}
+
+static unsigned long ScanRangeFrom (unsigned long freq, unsigned long low, unsigned long high)
+// First step of the range at or after freq that is inside the limits.  0 if there is none
+{
+  if (freq <= low) freq += ((low - freq) / scanstep + 1) * scanstep;
+  return (freq > scanstop || freq >= high) ? 0 : freq;
+}
+
+static unsigned long ScanNext (unsigned long low, unsigned long high)
+// Next dial frequency to try, above low and below high.  The limits move with the sideband so a range or channel
+// that was inside them when it was entered may not be now.  Returns 0 if nothing is inside them
+{
+  unsigned char i;
+
+  if (scanmode == SCAN_RANGE) {
+    scanfreq += scanstep;
+    if (scanfreq < scanstart) scanfreq = scanstart;
+    if (!(scanfreq = ScanRangeFrom (scanfreq, low, high))) scanfreq = ScanRangeFrom (scanstart, low, high);
+    return scanfreq;
+  }
+
+  // Memory channels, skipping the empty ones and those outside the limits
+  for (i = 0; i < SCAN_CHANNELS; i++) {
+    scanch = (scanch + 1) % SCAN_CHANNELS;
+    scanfreq = ScanChannelRead (scanch);
+    if (ScanInLimits (scanfreq, low, high)) return scanfreq;
+  }
+  return 0;
+}
+
+unsigned long ScanTask (unsigned long low, unsigned long high)
+// Call every pass of loop() while ScanActive().  Returns the dial frequency to tune to, 0 to stay.
+// Only frequencies above low and below high (dial Hz) are returned.  The scan stops if there are none
+{
+  Skinny_ADC_result_def adc;
+  unsigned long now = millis ();
+  unsigned long freq;
+
+  switch (scanstate) {
+    case SCAN_TUNE:
+      freq = ScanNext (low, high);
+      if (!freq) {
+        ScanStop ();
+        break;
+      }
+      scanstate = SCAN_SETTLING;
+      scantime = now;
+      return freq;
+
+    case SCAN_SETTLING:
+      if (now - scantime < scansettle) break;
+      AdcRestart ();
+      scanstate = SCAN_MEASURE;
+      break;
+
+    case SCAN_MEASURE:
+      if (!AdcResult (&adc)) break;
+      scanstats.channels++;
+      scanstats.level = SmeterBar ((unsigned int)(((unsigned long)adc.peak * 707) / 1000));
+      if (scanstats.level < scanthreshold) {
+        scanstate = SCAN_TUNE;
+        break;
+      }
+      scanstats.stops++;
+      scanstats.elapsed += now - scanmoving;
+      scanstate = SCAN_HOLD;
+      scantime = now;
+      break;
+
+    case SCAN_HOLD:
+      // Each new window above the threshold restarts the hang time
+      if (AdcResult (&adc)) {
+        scanstats.level = SmeterBar ((unsigned int)(((unsigned long)adc.peak * 707) / 1000));
+        if (scanstats.level >= scanthreshold) scantime = now;
+      }
+      if (now - scantime < scanhang) break;
+      scanmoving = now;
+      scanstate = SCAN_TUNE;
+      break;
+  }
+  return 0;
+}
+
+static unsigned char ScanCheck (unsigned char ch, uint32_t freq)
+// Check byte stored above the 24 bit frequency of channel ch
+{
+  unsigned int crc;
+
+  crc = EECRC16 (0xFFFF, ch);
+  crc = EECRC16 (crc, freq & 0xFF);
+  crc = EECRC16 (crc, (freq >> 8) & 0xFF);
+  crc = EECRC16 (crc, (freq >> 16) & 0xFF);
+  return crc & 0xFF;
+}
+
+void ScanChannelWrite (unsigned char ch, uint32_t freq)
+// 0 (or a frequency that does not fit in 24 bits) clears the channel
+{
+  if (ch >= SCAN_CHANNELS) return;
+  if (!freq || freq > SCAN_FREQ_MASK) {
+    freq = SCAN_EMPTY;
+  } else {
+    freq |= (uint32_t)ScanCheck (ch, freq) << 24;
+  }
+  EEPROMWrite (SCAN_EEPROM + ch * sizeof(freq), (char *)&freq, sizeof(freq));
+}
+
+unsigned long ScanChannelRead (unsigned char ch)
+// Returns 0 for an empty channel or one whose check byte does not match
+{
+  uint32_t freq;
+
+  if (ch >= SCAN_CHANNELS) return 0;
+  EEPROMRead (SCAN_EEPROM + ch * sizeof(freq), (char *)&freq, sizeof(freq));
+  if ((freq >> 24) != ScanCheck (ch, freq & SCAN_FREQ_MASK)) return 0;
+  return freq & SCAN_FREQ_MASK;
+}
@@ -0,0 +1,56 @@
+#ifndef _SKINNY_SCAN_H_
+#define _SKINNY_SCAN_H_
+
+// Scanner.  Steps through a frequency range or the memory channels and stops on a channel whose S meter
+// reading is at or above the squelch threshold.  It resumes once the signal has been below the threshold
+// for the hang time.  Per channel:
+//   retune     loop() calls SetFrequency() (fast tune, a few I2C bytes)
+//   settle     wait settle ms for the receiver audio to follow the new frequency
+//   measure    throw away the ADC window in progress and take the next whole one (ADC_WINDOW samples, 10.4 ms
+//              at 9.6 kHz).  The envelope is not used as its slow decay would carry a signal into the next channel
+// ScanTask() returns the next dial frequency, loop() tunes the radio so the display and Si5351 follow as for the encoder.
+// ScanTask() and ScanMemory() are given the dial limits for the current sideband and skip channels outside them.
+//
+// Each memory channel is 4 bytes: the frequency in the low 24 bits and a check byte on top.  A channel whose check byte
+// does not match (erased EEPROM, a message saved by older firmware that ran into these addresses) reads as empty.
+
+#define SCAN_CHANNELS   16          // Memory channels kept in EEPROM
+#define SCAN_EEPROM     448         // EEPROM address of the channels, 4 bytes each.  Ends at the settings journal
+#define SCAN_FREQ_MASK  0x00FFFFFFUL    // Channel frequencies are kept in 24 bits
+#define SCAN_EMPTY      0xFFFFFFFFUL    // Stored for a cleared channel, as erased EEPROM
+
+#define SCAN_SETTLE     3           // Default ms from retune to measure
+#define SCAN_HANG       2000        // Default ms to stay after the signal drops
+#define SCAN_THRESHOLD  30          // Default squelch as S meter bar pixels (0 to 68)
+
+#define SCAN_OFF        0
+#define SCAN_RANGE      1
+#define SCAN_MEMORY     2
+
+#define SCAN_TUNE       0           // Scanner states
+#define SCAN_SETTLING   1
+#define SCAN_MEASURE    2
+#define SCAN_HOLD       3
+
+typedef struct {
+  unsigned long channels;           // Channels measured since the scan started
+  unsigned long stops;              // Times the squelch opened
+  unsigned long elapsed;            // ms spent moving between channels (time held on a signal is left out)
+  unsigned char level;              // Last level measured (bar pixels)
+} Skinny_Scan_stats_def;
+
+extern unsigned char scansettle, scanthreshold;
+extern unsigned int scanhang;
+
+void ScanRange (unsigned long start, unsigned long stop, unsigned long step);
+unsigned char ScanMemory (unsigned long low, unsigned long high);
+void ScanStop (void);
+unsigned char ScanActive (void);
+unsigned long ScanTask (unsigned long low, unsigned long high);
+void ScanSettings (unsigned char settle, unsigned int hang, unsigned char threshold);
+unsigned char ScanLevel (void);
+void ScanStats (Skinny_Scan_stats_def *stats);
+void ScanChannelWrite (unsigned char ch, uint32_t freq);
+unsigned long ScanChannelRead (unsigned char ch);
+
+#endif // _SKINNY_SCAN_H_
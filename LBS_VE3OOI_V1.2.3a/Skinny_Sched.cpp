@@ -0,0 +1,70 @@
+#include "Arduino.h"
+
+#include "Skinny_Sched.h"
+#include "Skinny_Prof.h"
+
+// schedtasks is the table in flash.  schedlast[] is millis() when each periodic task last ran
+const Skinny_Task_def *schedtasks;
+unsigned char schedcount;
+unsigned long schedlast[SCHED_TASKS];
+Skinny_Sched_stats_def schedstats[SCHED_TASKS];
+
+void SchedInit (const Skinny_Task_def *tasks, unsigned char count)
+{
+  schedtasks = tasks;
+  schedcount = count > SCHED_TASKS ? SCHED_TASKS : count;
+  memset (schedlast, 0, sizeof(schedlast));
+  SchedReset ();
+}
+
+void SchedRun (void)
+// One pass.  Call from loop()
+{
+  Skinny_Task_def task;
+  Skinny_Sched_stats_def *p;
+  unsigned char i, periodic = 0;
+  unsigned long t;
+
+  for (i = 0; i < schedcount; i++) {
+    memcpy_P (&task, &schedtasks[i], sizeof(task));
+    if (task.period) {
+      if (periodic || millis () - schedlast[i] < task.period) continue;
+      periodic = 1;
+      schedlast[i] = millis ();
+    }
+
+    t = micros ();
+    task.run ();
+    t = micros () - t;
+
+    p = &schedstats[i];
+    p->runs++;
+    if (t > task.budget && p->overruns != 0xFFFF) p->overruns++;
+    if (t > p->max) p->max = t > 0xFFFF ? 0xFFFF : t;
+#if PROF_ENABLE
+    ProfAdd (task.prof, t);
+#endif
+  }
+}
+
+void SchedReset (void)
+// Clears the statistics
+{
+  memset (schedstats, 0, sizeof(schedstats));
+}
+
+unsigned char SchedCount (void)
+{
+  return schedcount;
+}
+
+void SchedTask (unsigned char task, Skinny_Task_def *def)
+// Copy of the table entry for task
+{
+  memcpy_P (def, &schedtasks[task], sizeof(*def));
+}
+
+void SchedStats (unsigned char task, Skinny_Sched_stats_def *stats)
+{
+  *stats = schedstats[task];
+}
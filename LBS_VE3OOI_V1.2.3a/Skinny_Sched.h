@@ -0,0 +1,32 @@
+#ifndef _SKINNY_SCHED_H_
+#define _SKINNY_SCHED_H_
+
+// Cooperative scheduler.  Tasks are listed in priority order in a table in flash and each runs to completion.
+// A task with a period of 0 is polled on every pass and must return straight away when it has nothing to do
+// (e.g. no serial data, the knob has not moved).  The others run when their period in ms has gone by, but only
+// the first one due runs on each pass.  So the polled tasks (retune) never wait for more than one periodic task.
+// Each run is timed against the task budget.  Runs that take longer are counted as overruns, they are not stopped.
+
+#define SCHED_TASKS  8              // Most tasks in a table
+
+typedef struct {
+  void (*run) (void);
+  unsigned int period;              // ms, 0 to poll every pass
+  unsigned int budget;              // us
+  unsigned char prof;               // Profiler stage (see Skinny_Prof.h), also gives the task name
+} Skinny_Task_def;
+
+typedef struct {
+  unsigned long runs;
+  unsigned int overruns;            // Runs longer than the budget
+  unsigned int max;                 // us, 65535 for longer
+} Skinny_Sched_stats_def;
+
+void SchedInit (const Skinny_Task_def *tasks, unsigned char count);
+void SchedRun (void);
+void SchedReset (void);
+unsigned char SchedCount (void);
+void SchedTask (unsigned char task, Skinny_Task_def *def);
+void SchedStats (unsigned char task, Skinny_Sched_stats_def *stats);
+
+#endif // _SKINNY_SCHED_H_
@@ -0,0 +1,97 @@
+#include "Arduino.h"
+
+#include "Skinny_Scope.h"
+#include "Skinny_ADC.h"
+
+// scopestart is the dial frequency of column 0 and scopestep the Hz per column.  scopemark is AdcSamples()
+// just after the retune.  scopex/scopelevel hold the last point measured until ScopeReady() takes it
+unsigned char scopeactive, scopestate, scopepoint, scopex, scopenew;
+unsigned long scopestart, scopestep, scopemark, scopetime;
+unsigned int scopelevel;
+Skinny_Scope_stats_def scopestats;
+
+void ScopeStart (unsigned long center, unsigned long span)
+// Starts sweeping center +/- span / 2 (dial Hz).  Call again to move the centre, the sweep continues
+{
+  if (!span) span = SCOPE_SPAN;
+  scopestep = span / (SCOPE_POINTS - 1);
+  if (!scopestep) scopestep = 1;
+  scopestart = center - scopestep * (SCOPE_POINTS / 2);
+  if (scopeactive) return;
+
+  scopeactive = 1;
+  scopestate = SCOPE_TUNE;
+  scopepoint = 0;
+  scopenew = 0;
+  memset (&scopestats, 0, sizeof(scopestats));
+  scopetime = millis ();
+}
+
+void ScopeStop (void)
+{
+  scopeactive = 0;
+}
+
+unsigned char ScopeActive (void)
+{
+  return scopeactive;
+}
+
+unsigned long ScopeSpan (void)
+{
+  return scopestep * (SCOPE_POINTS - 1);
+}
+
+void ScopeStats (Skinny_Scope_stats_def *stats)
+{
+  *stats = scopestats;
+}
+
+unsigned long ScopeTask (void)
+// Call every pass of loop() while ScopeActive().  Returns the dial frequency to tune CLK0 to, 0 to stay
+{
+  unsigned int buf[SCOPE_SAMPLES], peak;
+  unsigned char i;
+
+  switch (scopestate) {
+    case SCOPE_TUNE:
+      scopestate = SCOPE_MARK;
+      return scopestart + scopepoint * scopestep;
+
+    case SCOPE_MARK:
+      // loop() has retuned since the last call so samples from here on are for the new frequency
+      scopemark = AdcSamples ();
+      scopestate = SCOPE_WAIT;
+      break;
+
+    case SCOPE_WAIT:
+      if (AdcSamples () - scopemark < SCOPE_SETTLE + SCOPE_SAMPLES) break;
+      AdcHistory (buf, SCOPE_SAMPLES);
+      for (i = 0, peak = 0; i < SCOPE_SAMPLES; i++) {
+        if (buf[i] > peak) peak = buf[i];
+      }
+      scopex = scopepoint;
+      scopelevel = peak;
+      scopenew = 1;
+
+      if (++scopepoint >= SCOPE_POINTS) {
+        scopepoint = 0;
+        scopestats.sweeps++;
+        scopestats.sweepms = millis () - scopetime;
+        scopetime = millis ();
+      }
+      scopestate = SCOPE_TUNE;
+      break;
+  }
+  return 0;
+}
+
+unsigned char ScopeReady (unsigned char *x, unsigned int *level)
+// Returns 1 with the column and peak level (ADC counts) of a point measured since the last call
+{
+  if (!scopenew) return 0;
+  *x = scopex;
+  *level = scopelevel;
+  scopenew = 0;
+  return 1;
+}
@@ -0,0 +1,34 @@
+#ifndef _SKINNY_SCOPE_H_
+#define _SKINNY_SCOPE_H_
+
+// Bandscope.  Sweeps CLK0 over SCOPE_POINTS frequencies spread over a span centred on the dial frequency
+// and measures the audio detector (S meter input) at each one.  Per point:
+//   retune     loop() calls SetFrequency() for CLK0 (a small step so fast tune only moves the PLL)
+//   settle     the next SCOPE_SETTLE ADC samples are skipped while the receiver audio follows
+//   measure    the peak of the SCOPE_SAMPLES samples after that, taken from the ADC ring (AdcHistory())
+// At 9.6 kHz sampling a point is (8 + 16) / 9615 = 2.5 ms plus the retune, so a sweep of 84 points is
+// about 230 ms (over 4 sweeps a second).  The sketch draws each point as it arrives.
+
+#define SCOPE_POINTS   84           // One per display column
+#define SCOPE_SETTLE   8            // ADC samples skipped after a retune
+#define SCOPE_SAMPLES  16           // ADC samples measured per point.  No more than ADC_RING
+#define SCOPE_SPAN     25000        // Default span in Hz
+
+#define SCOPE_TUNE     0            // Bandscope states
+#define SCOPE_MARK     1
+#define SCOPE_WAIT     2
+
+typedef struct {
+  unsigned long sweeps;             // Sweeps completed since ScopeStart()
+  unsigned int sweepms;             // Time the last sweep took
+} Skinny_Scope_stats_def;
+
+void ScopeStart (unsigned long center, unsigned long span);
+void ScopeStop (void);
+unsigned char ScopeActive (void);
+unsigned long ScopeTask (void);
+unsigned char ScopeReady (unsigned char *x, unsigned int *level);
+unsigned long ScopeSpan (void);
+void ScopeStats (Skinny_Scope_stats_def *stats);
+
+#endif // _SKINNY_SCOPE_H_
@@ -0,0 +1,197 @@
+#include "Arduino.h"
+#include <avr/pgmspace.h>
+
+#include "Skinny_TX.h"
+
+// txqueue[] holds the items waiting to be sent, txhead is the next free entry and txtail the one being sent.
+// The entry being sent is updated in place (str moves along the string) so a long message is sent a bit
+// per TxPump().  A number is converted to txnum[] when it reaches the tail.  Only loop() uses these
+typedef struct {
+  unsigned char type;
+  union {
+    const char *str;
+    unsigned long value;
+  };
+} Skinny_TX_item_def;
+
+Skinny_TX_item_def txqueue[TX_QUEUE];
+unsigned char txhead, txtail;
+char txnum[32];
+
+// Reply being queued a row at a time by TxRows().  txrowfn is NULL when there is none.
+// txafter is a flash string queued after its last row (the console prompt)
+void (*txrowfn) (unsigned char row);
+unsigned char txrow, txrows;
+const char *txafter;
+
+static void TxNext (void);
+static void TxDrain (void);
+
+static void TxPut (unsigned char type, const char *str, unsigned long value)
+{
+  unsigned char head = txhead, next = (txhead + 1) % TX_QUEUE;
+
+  while (next == txtail) TxNext ();
+
+  txqueue[head].type = type;
+  if (TX_TYPE (type) == TX_FLASH || TX_TYPE (type) == TX_STRING) {
+    txqueue[head].str = str;
+  } else {
+    txqueue[head].value = value;
+  }
+  txhead = next;
+
+  TxDrain ();
+}
+
+void TxFlash (const char *str)
+// str must be in PROGMEM, e.g. TxFlash (PSTR ("text"))
+{
+  TxPut (TX_FLASH, str, 0);
+}
+
+void TxString (const char *str)
+// str must still be valid when it is sent (a literal or a global)
+{
+  TxPut (TX_STRING, str, 0);
+}
+
+void TxNumber (long value)
+{
+  TxPut (TX_SIGNED, NULL, value);
+}
+
+void TxUnsigned (unsigned long value)
+{
+  TxPut (TX_UNSIGNED, NULL, value);
+}
+
+void TxDigits (unsigned long value, unsigned char digits)
+// Unsigned with leading zeros to fill digits (up to 31)
+{
+  TxPut (TX_UNSIGNED | ((digits & 0x1F) << 3), NULL, value);
+}
+
+void TxChar (char c)
+{
+  TxPut (TX_CHAR, NULL, (unsigned char)c);
+}
+
+void TxNewLine (void)
+{
+  TxFlash (PSTR ("\r\n"));
+}
+
+static void TxConvert (Skinny_TX_item_def *item)
+// Turns a number item into a string in txnum[]
+{
+  unsigned long value = item->value;
+  char *ptr = &txnum[sizeof(txnum) - 1];
+  unsigned char neg = 0, width = item->type >> 3;
+
+  if (item->type == TX_SIGNED && (long)value < 0) {
+    value = -(long)value;
+    neg = 1;
+  }
+  *ptr = 0;
+  do {
+    *--ptr = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (ptr > &txnum[sizeof(txnum) - 1 - width]) *--ptr = '0';
+  if (neg) *--ptr = '-';
+
+  item->type = TX_STRING;
+  item->str = ptr;
+}
+
+static void TxNext (void)
+// Sends the next character of the item at the tail.  Serial.write() waits if the TX buffer is full
+{
+  Skinny_TX_item_def *item = &txqueue[txtail];
+  char c;
+
+  if (TX_TYPE (item->type) == TX_SIGNED || TX_TYPE (item->type) == TX_UNSIGNED) TxConvert (item);
+
+  if (item->type == TX_CHAR) {
+    c = (char)item->value;
+  } else {
+    c = (item->type == TX_FLASH) ? (char)pgm_read_byte (item->str) : *item->str;
+    item->str++;
+  }
+
+  if (item->type == TX_CHAR || !c) txtail = (txtail + 1) % TX_QUEUE;
+  if (c) Serial.write (c);
+}
+
+static void TxDrain (void)
+// Sends as much as fits in the Serial TX buffer without waiting
+{
+  while (txtail != txhead && Serial.availableForWrite () > 0) TxNext ();
+}
+
+static void TxFill (void)
+// Queues the next rows of a TxRows() reply while the queue has room for a whole row, then txafter
+{
+  void (*row) (unsigned char row);
+
+  while (txrowfn && TX_QUEUE - 1 - TxPending () >= TX_ROW_ITEMS) {
+    row = txrowfn;
+    if (txrow + 1 >= txrows) txrowfn = NULL;
+    row (txrow++);
+  }
+  if (!txrowfn && txafter && TxPending () < TX_QUEUE - 1) {
+    TxFlash (txafter);
+    txafter = NULL;
+  }
+}
+
+void TxRows (void (*row) (unsigned char row), unsigned char rows)
+// Queues rows 0 to rows - 1 of a reply by calling row() for each as the queue empties.  row() must queue no more
+// than TX_ROW_ITEMS items and only use data that is still valid when it is called (globals, not locals of the caller)
+{
+  if (TxBusy ()) TxFlush ();      // Only one at a time.  Input waits while one is running so this should not happen
+  if (!rows) return;
+  txrowfn = row;
+  txrow = 0;
+  txrows = rows;
+  TxFill ();
+}
+
+void TxFlashAfter (const char *str)
+// Like TxFlash() but after the rows TxRows() has still to queue
+{
+  if (TxBusy ()) {
+    txafter = str;
+  } else {
+    TxFlash (str);
+  }
+}
+
+void TxPump (void)
+// Call often (every pass of loop()).  Sends as much as fits in the Serial TX buffer without waiting
+{
+  TxDrain ();
+  TxFill ();
+}
+
+unsigned char TxPending (void)
+// Items still queued (0 means everything is in the Serial TX buffer)
+{
+  return (txhead + TX_QUEUE - txtail) % TX_QUEUE;
+}
+
+unsigned char TxBusy (void)
+// 1 while TxRows() has rows (or the string after them) left to queue
+{
+  return txrowfn || txafter;
+}
+
+void TxFlush (void)
+// Waits until the queue is empty and all rows are queued.  Needed before code that writes to Serial directly
+{
+  while (TxBusy () || TxPending ()) {
+    TxFill ();
+    if (TxPending ()) TxNext ();
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef _SKINNY_TX_H_
+#define _SKINNY_TX_H_
+
+// Serial output queue.  Console and CAT output is queued as references (a flash string, a RAM string that
+// stays valid such as a literal, a number or a character) and TxPump() moves it into the Serial TX buffer only
+// as far as there is room.  The TX interrupt of HardwareSerial sends the buffer in the background so loop()
+// never waits for the UART, even for the help text.  Only a full queue waits (for the UART to take a byte).
+//
+// A reply longer than the queue (a table) is given to TxRows() as a function that queues one row.  TxPump() calls
+// it for the next row each time the queue has room for TX_ROW_ITEMS, so the reply never fills the queue.
+// TxBusy() is set until the last row and the TxFlashAfter() string (the prompt) are queued.  Console and CAT
+// input waits for it (see ProcessSerial()).
+//
+// Everything written to the console must go through here so the output stays in order.
+
+#define TX_QUEUE 24             // Queued items.  Must be no more than 128
+#define TX_ROW_ITEMS (TX_QUEUE - 2)   // Most items one row of TxRows() may queue
+
+#define TX_FLASH    0
+#define TX_STRING   1
+#define TX_SIGNED   2
+#define TX_UNSIGNED 3
+#define TX_CHAR     4
+#define TX_TYPE(t)  ((t) & 0x07)  // The upper 5 bits of the type are the width for TxDigits()
+
+void TxFlash (const char *str);
+void TxString (const char *str);
+void TxNumber (long value);
+void TxUnsigned (unsigned long value);
+void TxDigits (unsigned long value, unsigned char digits);
+void TxChar (char c);
+void TxNewLine (void);
+void TxRows (void (*row) (unsigned char row), unsigned char rows);
+void TxFlashAfter (const char *str);
+void TxPump (void);
+unsigned char TxPending (void);
+unsigned char TxBusy (void);
+void TxFlush (void);
+
+#endif // _SKINNY_TX_H_
@@ -2,6 +2,9 @@
 #include "Arduino.h"
 
 #include "Skinny_UART.h"
+#include "Skinny_CAT.h"
+#include "Skinny_TX.h"
+#include "Skinny_Mem.h"
 #include "VE3OOI_Si5351_v1.3.h"         // VE3OOI Si5351 Routines
 #include "LBS_VE3OOI_V1.3.h"
 
@@ -20,8 +23,7 @@ unsigned char ctr;
 void ResetSerial (void) 
 // This routine is used to flush all serial input output and zero out all serial buffers
 {
-  //Empty input and output buffers
-  Serial.flush();
+  //Empty the input buffer.  Output is left to drain in the background (see Skinny_TX.h)
   while (Serial.available() > 0) ctr=Serial.read();
   
   // Zero arrays
@@ -33,40 +35,51 @@ void ResetSerial (void)
 }
 
 char ProcessSerial ( void ) 
-// This routing is called to check is there is serial input and store the input into the serial buffer
-// if a CR/LF (Enter pressed) is received, then process the command and flush the buffer.
+// This routing is called to check is there is serial input.  Each character goes to CatInput() which passes
+// everything that is not a CAT command on to ConsoleInput().
+// Input is left in the Serial RX buffer while a long reply is still being queued so replies do not mix
 {
-    char temp;
+    if (TxBusy ()) return 0;
 
     // Serial.available() returns the number of character that have been entered at the keyboard.
     // The idea here is that you keep processing characters until none are left.
-    // This routine is faster that a user's typing and it needs to check for CR/LF 
     while (Serial.available() > 0) {
-      
-        if (ctr < sizeof(rbuff)) {
-            temp = Serial.read();       // Read a character
-            Serial.write(temp);         // Echo the character back to the user
-            if (isPrintable (temp)) {   // If the character is alphabetic than store it in the buffer
-              rbuff[ctr++] = temp;
-            } else if (temp == 0xD || temp == 0xA) {    // If the character is not printable and its a CR/LF then process the buffer
-              if (ctr) {
-                 Serial.println ("");
-                 ExecuteSerial (rbuff);
-                 ResetSerial ();
-                 Serial.write ("\r\nRDY> ");
-              }
-            }
-        }
-        // This checks to see if the users has entered too much data which would overflew the serial buffer
-        // the UART.h file details the MAX number of characters
-        if (ctr > sizeof(rbuff)) {
-            Serial.println ("OVLF");
-            ResetSerial ();
-            Serial.write ("\r\nRDY> "); 
-            break;
-        } 
+        CatInput (Serial.read());
     }
+    return 0;
+}
 
+void ConsoleInput ( char temp )
+// Store a console character into the serial buffer.
+// if a CR/LF (Enter pressed) is received, then process the command and flush the buffer.
+{
+    TxChar(temp);               // Echo the character back to the user
+    if (isPrintable (temp)) {   // If the character is alphabetic than store it in the buffer
+      rbuff[ctr++] = temp;
+    } else if (temp == 0xD || temp == 0xA) {    // If the character is not printable and its a CR/LF then process the buffer
+      if (ctr) {
+         TxNewLine ();
+         MEM_SITE_BEGIN ();
+         ExecuteSerial (rbuff);
+         MEM_SITE_END (MEM_SITE_CONSOLE);
+         ResetSerial ();
+         TxFlashAfter (PSTR ("\r\nRDY> "));
+      }
+    }
+
+    // This checks to see if the users has entered too much data which would overflew the serial buffer
+    // the UART.h file details the MAX number of characters.  The last byte is kept for the terminating zero
+    if (ctr >= sizeof(rbuff) - 1) {
+        TxFlash (PSTR ("OVLF\r\n"));
+        ResetSerial ();
+        TxFlash (PSTR ("\r\nRDY> ")); 
+    } 
+}
+
+unsigned char ConsoleIdle ( void )
+// Returns 1 if nothing has been typed on the current console line
+{
+    return !ctr;
 }
 
 unsigned char ParseSerial ( char *str )
@@ -77,16 +90,13 @@ unsigned char ParseSerial ( char *str )
         memset(numbers,0,sizeof(numbers));   // Flush out the arrays
         memset(commands,0,sizeof(commands));
         
-	for (i=0, j=0, k=0; i<strlen(str); i++) {        // Step through the serial buffer - str is a pointer to the serial buffer
+	for (i=0, j=0, k=0; str[i]; i++) {        // Step through the serial buffer - str is a pointer to the serial buffer
 		if ( isalpha( str[i] ) ) {               // Its alphabetic so store it in commands[]
-			commands[j++] = toupper(str[i]);
+			if (j < MAX_COMMAND_ENTRIES) commands[j++] = toupper(str[i]);
 		} else if ( isdigit( str[i] ) ) {
-			numbers[k++] = strtol ( (char *)&str[i], NULL, 10 );
-			while ( isdigit( str[i+1] ) ) {
-				if (i >= strlen(str)) break;
-				i++;
-			}
-		} else if ( isgraph( str[i] ) ) {
+			if (k < MAX_COMMAND_ENTRIES) numbers[k++] = strtol ( (char *)&str[i], NULL, 10 );
+			while ( isdigit( str[i+1] ) ) i++;     // Stops at the terminating zero
+		} else if ( isgraph( str[i] ) && j < MAX_COMMAND_ENTRIES ) {
 			commands[j++] = str[i];
 		}
 	}
@@ -98,7 +108,7 @@ void ErrorOut ( void )
 // This routine is used to print out an error message.
 // An argument could be passed with an error code which is decoded here. 
 {
-  Serial.println ("Input/Command Err");
+  TxFlash (PSTR ("Input/Command Err\r\n"));
 }
 
 
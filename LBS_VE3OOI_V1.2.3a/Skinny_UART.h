@@ -2,10 +2,12 @@
 #define _UART_H_
 
 
-#define RBUFF 16		// Max RS232 Buffer Size
+#define RBUFF 32		// Max RS232 Buffer Size (one less for the terminating zero)
 #define MAX_COMMAND_ENTRIES 3 
 
 char ProcessSerial ( void );
+void ConsoleInput ( char c );
+unsigned char ConsoleIdle ( void );
 unsigned char ParseSerial ( char *str );
 void ResetSerial (void);
 void ErrorOut ( void );
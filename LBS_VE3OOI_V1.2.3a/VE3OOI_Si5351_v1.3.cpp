@@ -16,10 +16,18 @@ Si5351_CLK_def clk0ctl;
 Si5351_CLK_def clk1ctl;
 Si5351_CLK_def clk2ctl;
 
-// These are variables used by the various routines.  Its globally defined to conserve ram memory
-unsigned long temp;
-unsigned char base;
-unsigned char clkreg;
+// Register block shared by the routines below.  The divider math (P1, P2, P3) is done on the stack by EncodeDivider()
+unsigned char msregs[SI_MSREGS];     // Encoded 8 register parameter block sent to the Si5351 in one I2C burst
+
+// Shadow copy of the Si5351 registers written by these routines.  Writes that match the shadow are not sent over I2C.
+// si5351valid[] has one bit per shadow entry and is cleared by Si5351InvalidateShadow() so the next write always goes out.
+// si5351stats counts what was sent and what was skipped.
+unsigned char si5351shadow[SI_SHADOW_REGS];
+unsigned char si5351valid[(SI_SHADOW_REGS + 7) / 8];
+Si5351_stats_def si5351stats;
+
+// When set, small retunes keep the output multisynth fixed and only move the PLL. See FastTuneFrequency()
+unsigned char fasttune = 1;
 
 /*
 The way the Si5351 works (in a nutshell) is the a PLL frequency is generated based on the Crystal Frequency (XTAL).  A multisyncth multiplier (called Feedback Multisynth Divider
@@ -35,7 +43,7 @@ Clock Output Frequency = Desired Frequency = PLL_Frequency / (MS_A + MS_B / MS_C
 Therefore its critical to get the B/C ratio to represent the fractional component of the divider/multiplier.  
 For example, to generate a PLL frequency of 612500000 Hz (612.5 Mhz), we need to multiply the 25Mhz crystal frequency by 24.5 or (24 + 1/2) so B/C = 1/2
 
-The FareyFraction () routine take a decimal number (e.g. 0.5) and generates approprite B & C values to represent the decimal number.
+The BestFraction () routine take a fraction num/den (e.g. 1/2) and generates approprite B & C values with C no bigger than FAREY_N to represent it.
 
 The A, B and C values are encoded and then written to various Si5351 registers.
 
@@ -47,39 +55,27 @@ The multsynth structure is used to define parameters used to configure PLL and M
 represent a running state.  
 
 multisynth.Fxtal is the reference crystal clock
-multisynth.Fxtalcorr is the adjusted/corrected reference crystal clock based on correction/calibration value
-multisynth.correction correction for xtal in parts per 10 million
+multisynth.correction correction for xtal in parts per billion (ppb). E.g. 1500 means the crystal runs 1.5 ppm fast
 multisynth.PLL is the PLL to use either 'A' or 'B'
-multisynth.MS_Fout is the output frequency
-multisynth.PLL_Fvco is the PLL Clock Frequency (Max 900 MHz)
 
 multisynth.ClkEnable is a parameter used to enable or disable the clock being configured
 
-multisynth.MSN_P1 is PLL Feedback Multisynth Divider
-multisynth.MSN_P2 is PLL Feedback Multisynth Divider
-multisynth.MSN_P3 is PLL Feedback Multisynth Divider
-multisynth.PLL_a is PLL Feedback Multisynth Divider
-multisynth.PLL_b is PLL Feedback Multisynth Divider
-multisynth.PLL_c is PLL Feedback Multisynth Divider
+The PLL frequency (PLL_Fvco, max 900 Mhz), the output frequency (MS_Fout) and the dividers are not kept in the structure.
+They are passed to the routines below and the dividers are Si5351_div_def locals of SetupFrequency() and SetupSi5351PLL().
 
-multisynth.PLL_Fvco = multisynth.Fxtal * (multisynth.PLL_a + multisynth.PLL_b/multisynth.PLL_c)
+PLL Feedback Multisynth Divider (a, b, c):
+PLL_Fvco = multisynth.Fxtal * (a + b/c)
 where a, b, c are fractional dividers for PLL frequency
 a is multiplier, b is numerator and c is demonator (a+b/c)
 
-multisynth.MS_a is Output Multisynth Divider
-multisynth.MS_b is Output Multisynth Divider
-multisynth.MS_c is Output Multisynth Divider
-multisynth.MS_P1 is Output Multisynth Divider
-multisynth.MS_P2 is Output Multisynth Divider
-multisynth.MS_P3 is Output Multisynth Divider
-
-multisynth.MS_Fout = multisynth.PLL_Fvco * (multisynth.MS_a + multisynth.MS_b/multisynth.MS_c)
+Output Multisynth Divider (a, b, c):
+MS_Fout = PLL_Fvco / (a + b/c)
 
-To convert a, b and c to P1, P2 and P3 the following calculation is done for either PLL multisynch divider or output multisynch output
-temp = (128*multisynth.MS_b)/multisynth.MS_c;      // Note that 128*multisynth.MS_b is done first to have the most accurate integer value
-multisynth.MS_P1 = 128 * multisynth.MS_a + temp - 512;
-multisynth.MS_P2 = 128 * multisynth.MS_b - multisynth.MS_c * temp;
-multisynth.MS_P3 = multisynth.MS_c;
+To convert a, b and c to P1, P2 and P3 the following calculation is done by EncodeDivider() for either PLL multisynch divider or output multisynch output
+temp = (128*b)/c;      // Note that 128*b is done first to have the most accurate integer value
+P1 = 128 * a + temp - 512;
+P2 = 128 * b - c * temp;
+P3 = c;
 where a, b, c are fractional dividers for output
 a is multiplier, b is numerator and c is demonator (a+b/c)
 
@@ -104,10 +100,9 @@ clk0ctl, clk1ctl and clk2ctl structure are all the same except they are dedicate
 At any point in time, these structures defines how the clock is configured.
 
 clk0ctl.PLL is the PLL that is assigned to the clock. Either "A" or "B"
-clk0ctl.mAdrive is the actual mA for the output i.e. 2, 4, 6, 8.  The UpdateDrive() routine converts to appropriate register value
 clk0ctl.phase is the phase from 0 to clk0ctl.maxangle. Each binary value increments the delay for the output frequency by 1 / (4 x clk0ctl.PLLFreq)
 clk0ctl.maxangle is the maximum phase based on the PLL Frequency used to generate the output frequency
-clk0ctl.reg is the control register (16,17,18) value that was last written to the Si5351
+clk0ctl.reg is the control register (16,17,18) value that was last written to the Si5351.  Its low 2 bits are the mA drive
 clk0ctl.freq is the output frequency for the running clock
 clk0ctl.PLLFreq is the PLL Frequency that is used to generate the output frequency
 */
@@ -119,28 +114,35 @@ void ResetSi5351 (unsigned int loadcap)
 // For the Adafruit module, its 25 Mhz. There are no other Adafruit modules.
 {
   unsigned char i;
+  long correction;
   
-  // Zero all clk registers and multisynth variables
+  // Zero all clk registers and multisynth variables.  The crystal correction is kept as it is a calibration value not a running state
+  correction = multisynth.correction;
   memset ((char *)&clk0ctl, 0, sizeof(clk0ctl));
   memset ((char *)&clk1ctl, 0, sizeof(clk1ctl));
   memset ((char *)&clk2ctl, 0, sizeof(clk2ctl));
   memset ((char *)&multisynth, 0, sizeof(multisynth));
+  multisynth.correction = correction;
+
+  // Start the I2C interface once here rather than on every register write
+  Wire.begin();
+  Wire.setClock(SI_I2C_CLOCK);
+
+  // The chip state is unknown so every register written below must go out.  This also reseeds the shadow.
+  Si5351InvalidateShadow ();
 
   // Disable clock outputs
   Si5351WriteRegister (SIREG_3_OUTPUT_ENABLE_CTL, 0xFF);  // Each bit corresponds to a clock outpout.  1 to disable, 0 to enable
 
-  // Power off CLK0, CLK1, CLK2
-  Si5351WriteRegister (SIREG_16_CLK0_CTL, 0x80);      // Bit 8 must be set to power down clock, clear to enable. 1 to disable, 0 to enable
-  Si5351WriteRegister (SIREG_17_CLK1_CTL, 0x80);
-  Si5351WriteRegister (SIREG_18_CLK2_CTL, 0x80);
+  // Power off CLK0, CLK1, CLK2. Bit 8 must be set to power down clock, clear to enable. 1 to disable, 0 to enable
+  // The three control registers are consecutive so they are written in one burst
+  memset (msregs, 0x80, 3);
+  Si5351WriteRegisters (SIREG_16_CLK0_CTL, msregs, 3);
 
-  // Zero ALL multisynth registers.
-  for (i = 0; i < SI_MSREGS; i++) {
-    Si5351WriteRegister (SIREG_26_MSNA_1 + i, 0x00);
-    Si5351WriteRegister (SIREG_34_MSNB_1 + i, 0x00);
-    Si5351WriteRegister (SIREG_42_MSYN0_1 + i, 0x00);
-    Si5351WriteRegister (SIREG_50_MSYN1_1 + i, 0x00);
-    Si5351WriteRegister (SIREG_58_MSYN2_1 + i, 0x00);
+  // Zero ALL multisynth registers. Each 8 register block (MSNA, MSNB, MS0, MS1, MS2) is one burst
+  memset (msregs, 0, sizeof(msregs));
+  for (i = SIREG_26_MSNA_1; i <= SIREG_58_MSYN2_1; i += SI_MSREGS) {
+    Si5351WriteRegisters (i, msregs, SI_MSREGS);
   }
 
   // Set Crystal Internal Load Capacitance. For Adafruit module its 8 pf
@@ -151,27 +153,19 @@ void ResetSi5351 (unsigned int loadcap)
 }
 
 
-void SetupSi5351PLL (char pll)
-// This routines configures the PLL multisynch multiplier
+void SetupSi5351PLL (char pll, unsigned long pllfreq)
+// This routines configures the PLL multisynch multiplier for a PLL frequency of pllfreq
 //  Before calling this routine, the following must be set
 //  multisynth.Fxtal must be set for Adafruit i.e. set to 25 Mhz
-//  multisynth.PLL_Fvco is used for to set PLL frequency
-//  multisynth.correction should be 0 for no correction or factor in parts per 10 million
-//  Note: The CalculatePLLDividers ()defines the multisynth.Fxtalcorr which is the corrected crystal frequency
+//  multisynth.correction should be 0 for no correction or factor in parts per billion
 {
-//  unsigned long temp;
-//  unsigned char base;
+  Si5351_div_def fb;
+  unsigned char base;
 
   multisynth.PLL = pll;
 
-  // Calculate a,b,c for specified PLL frequency in multisynth structure
-  CalculatePLLDividers ();
-
-  // Encode Fractional PLL Feedback Multisynth Divider into P1, P2 and P3
-  temp = (128 * multisynth.PLL_b) / multisynth.PLL_c;
-  multisynth.MSN_P1 = 128 * multisynth.PLL_a + temp - 512;
-  multisynth.MSN_P2 = 128 * multisynth.PLL_b - multisynth.PLL_c * temp;
-  multisynth.MSN_P3 = multisynth.PLL_c;
+  // Calculate a,b,c for specified PLL frequency
+  CalculatePLLDividers (pllfreq, &fb);
 
   // define the base resister for PLLA or PLLB
   if (multisynth.PLL == SI_PLL_A) {
@@ -180,19 +174,23 @@ void SetupSi5351PLL (char pll)
     base = SIREG_34_MSNB_1;                        // Base register address for PLL b
   }
   
-  // Write the data to the Si5351
-  Si5351WriteRegister( base++, (multisynth.MSN_P3 & 0x0000FF00) >> 8);
-  Si5351WriteRegister( base++, (multisynth.MSN_P3 & 0x000000FF));
-  Si5351WriteRegister( base++, (multisynth.MSN_P1 & 0x00030000) >> 16);
-  Si5351WriteRegister( base++, (multisynth.MSN_P1 & 0x0000FF00) >> 8);
-  Si5351WriteRegister( base++, (multisynth.MSN_P1 & 0x000000FF));
-  Si5351WriteRegister( base++, ((multisynth.MSN_P3 & 0x000F0000) >> 12) |
-                       ((multisynth.MSN_P2 & 0x000F0000) >> 16) );
-  Si5351WriteRegister( base++, (multisynth.MSN_P2 & 0x0000FF00) >> 8);
-  Si5351WriteRegister( base, (multisynth.MSN_P2 & 0x000000FF));
+  // Write the data to the Si5351 as one 8 register burst
+  // Note the PLL is not reset here.  A small change to the feedback divider is tracked by the PLL without a glitch.
+  // SetupFrequency() calls ResetSi5351PLL() when the output divider changes.
+  // Fractional PLL Feedback Multisynth Divider encoded into P1, P2 and P3
+  EncodeDivider (fb.a, fb.b, fb.c);
+  Si5351WriteRegisters (base, msregs, SI_MSREGS);
+}
 
-  // Reset PLLA (bit 5 set) & PLLB (bit 7 set)
-  Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLA_RESET | SI_PLLB_RESET );
+void ResetSi5351PLL (char pll)
+// This routine resets only the PLL specified ("A" or "B") so a clock running from the other PLL is not disturbed
+{
+  // Reset PLLA (bit 5 set) or PLLB (bit 7 set)
+  if (pll == SI_PLL_A) {
+    Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLA_RESET);
+  } else if (pll == SI_PLL_B) {
+    Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLB_RESET);
+  }
 }
 
 void SetFrequency (unsigned char clk, char pll, unsigned long freq, unsigned char drive)
@@ -209,10 +207,23 @@ void SetupFrequency (unsigned char clk, char pll, unsigned long pllfreq, unsigne
 // This is the detailed call to configure a frequency.  It requires Clk (0,1,2), PLL (A or B), pllfreq (0 for autodetermine or 600-900 Mhz), phase (0-max angle), mAdrive (2,4,6,8 mA)
 // See note above about phase configuration and programming note AN619
 // Note that SI_XTAL can be use instead of PLL "A" or "B".  This simply passes crystal frequency to the output (i.e. output is 25 Mhz and multiplier and dividers are not used).
+// The PLL is only reset when the output divider, R_DIV, DIVBY4, PLL source or phase of the clock changes.
 {
-//  unsigned long temp;
-//  unsigned char base;
-//  unsigned char clkreg;
+  Si5351_CLK_def *ctl;
+  Si5351_div_def ms;
+  unsigned char base, clkreg, resetpll, oldphase;
+  unsigned int msint;
+
+  if (clk > SI_CLK2) return;
+
+  // For small moves try to keep the output divider and only retune the PLL.  No PLL reset is needed in that case.
+  // A phase offset is counted in PLL periods and needs a PLL reset so a clock that has one or is given one takes the full path.
+  // The drive is set by UpdateDrive() which only writes the control register if it changed
+  ctl = GetClkControl (clk);
+  if (pllfreq == SI_AUTO_PLL_FREQ && !phase && !ctl->phase && FastTuneFrequency (clk, pll, freq)) {
+    UpdateDrive (clk, mAdrive);
+    return;
+  }
 
   // Validate frequency limits
   if (freq > SI_MAX_OUT_FREQ) {
@@ -222,43 +233,23 @@ void SetupFrequency (unsigned char clk, char pll, unsigned long pllfreq, unsigne
     freq = SI_MIN_OUT_FREQ;
   }
 
-  // define the fequency to be used. This variable is used by other routines.
-  multisynth.MS_Fout = freq;
-
   if (pllfreq == 0) {
     // CalculatePLLFrequency () determines the best integer multiplier for PLL and MS.  If an interger can be used it will use it. Integer multipiers/dividers are more stable
     // If a whole integer cannot be found then select a PLL frequency based on PLL MS multiplier closest to an interger value (e.g. 4.97 or 4.01)
     // It use a interger multipler to get PLL frequency from clock frequency (e.g. 9 Mhz uses an interger divider of 100 to calculate output frequency from 900 Mhz PLL frequency)
-    CalculatePLLFrequency (freq);
+    pllfreq = CalculatePLLFrequency (freq, &ms);
 
   } else {
     // In this case use provided PLL frequency and then calculate MS dividers for the given PLL frequency. This is stable however Si5351 states that integer multipler/dividers are preferred.
-    multisynth.PLL_Fvco = pllfreq;
+    // CalculateCLKDividers() determines A, B and C for multisynth divider for clock.  It divides down to freq before ValidateFrequency() below.
+    CalculateCLKDividers (pllfreq, freq, &ms);
     // The ValidateFrequency() call checks if frequency is below 1 Mhz or above 100 Mhz or above 150 Mhz.  See note above for frequencies below 1 Mhz or above 150 Mhz.  Frequencies
     // between 100 Mhz and 150 Mhz can be easily done using an integer multipler (i.e. use a fixed multipler of 6 - 6x100 Mhx is 600 Mhz which is inside PLL frequency requirement
     freq = ValidateFrequency (freq);
-    // CalculateCLKDividers() determines A, B and C for multisynth divider for clock.
-    CalculateCLKDividers ();
   }
-  // Based on multisynth.PLL_Fvco value program the PLL register specified by pll variable (i.e "A" or "B")
+  // Based on pllfreq program the PLL register specified by pll variable (i.e "A" or "B")
   // It determies A, B and C then encoded into P1, P2 and P3 then write to PLL A or PLL B registers.
-  SetupSi5351PLL (pll);
-
-//  multisynth.MS_Fout = freq;
-  if (freq <= SI_MAX_MS_FREQ) {
-    // Fractional mode
-    // encode A, B and C for multisynth divider into P1, P2 and P3
-    temp = (128 * multisynth.MS_b) / multisynth.MS_c;
-    multisynth.MS_P1 = 128 * multisynth.MS_a + temp - 512;
-    multisynth.MS_P2 = 128 * multisynth.MS_b - multisynth.MS_c * temp;
-    multisynth.MS_P3 = multisynth.MS_c;
-
-  } else {
-    // Integer mode used only when fequency is over 150 Mhz.
-    multisynth.MS_P1 = 0;
-    multisynth.MS_P2 = 0;
-    multisynth.MS_P3 = 1;
-  }
+  SetupSi5351PLL (pll, pllfreq);
 
   // Set the base register for the Multisynth diveder for the clock
   // clkreg is the actual data that will be written to the clock control register and we need to build it up based on parameters passed to this routine
@@ -270,26 +261,24 @@ void SetupFrequency (unsigned char clk, char pll, unsigned long pllfreq, unsigne
   } else if (clk == SI_CLK1) {
     base = SIREG_50_MSYN1_1;	        // Base register address for Out 1
     clkreg = clk1ctl.reg;
-  } else if (clk == SI_CLK2) {
+  } else {
     base = SIREG_58_MSYN2_1;	        // Base register address for Out 2
     clkreg = clk2ctl.reg;
   }
   
-  // Write the values to the corresponding register
-  Si5351WriteRegister( base++, (multisynth.MS_P3 & 0x0000FF00) >> 8);
-  Si5351WriteRegister( base++, (multisynth.MS_P3 & 0x000000FF));
-
-  Si5351WriteRegister( base++, (
-                         ((multisynth.MS_P1 & 0x00030000) >> 16) |
-                         ((multisynth.R_DIV & 0x7) << 4) |
-                         ((multisynth.MS_DIVBY4 & 0x3) << 2)) );
-
-  Si5351WriteRegister( base++, (multisynth.MS_P1 & 0x0000FF00) >> 8);
-  Si5351WriteRegister( base++, (multisynth.MS_P1 & 0x000000FF));
-  Si5351WriteRegister( base++, ((multisynth.MS_P3 & 0x000F0000) >> 12) |
-                       ((multisynth.MS_P2 & 0x000F0000) >> 16) );
-  Si5351WriteRegister( base++, (multisynth.MS_P2 & 0x0000FF00) >> 8);
-  Si5351WriteRegister( base, (multisynth.MS_P2 & 0x000000FF));
+  if (freq <= SI_MAX_MS_FREQ) {
+    // Fractional mode
+    // encode A, B and C for multisynth divider into P1, P2 and P3
+    EncodeDivider (ms.a, ms.b, ms.c);
+  } else {
+    // Integer mode used only when fequency is over 150 Mhz.
+    EncodeMultisynth (0, 0, 1);
+  }
+
+  // Write the values to the corresponding register as one 8 register burst
+  // The R_DIV and DIVBY4 bits share the third register with the top bits of P1
+  msregs[2] |= ((multisynth.R_DIV & 0x7) << 4) | ((multisynth.MS_DIVBY4 & 0x3) << 2);
+  Si5351WriteRegisters (base, msregs, SI_MSREGS);
 
 /*
 Reg 16-18: Power up clock, set fractional mode, set PLLA, set MultiSynth 0 as clock source, current output
@@ -354,39 +343,48 @@ For clock control register, the bits are as follows
   }
 
 
+  // The PLL needs a reset if the output divider chain is different from what the clock was running with.
+  // Only a whole number divider is kept in MS_a.  FastTuneFrequency() sets the PLL to freq x MS_a so a fractional one (b not 0)
+  // is stored as 0 and the next retune takes the full path
+  msint = ms.b ? 0 : ms.a;
+  resetpll = !ctl || ctl->PLL != pll || ctl->MS_a != msint ||
+             ctl->R_DIV != multisynth.R_DIV || ctl->MS_DIVBY4 != multisynth.MS_DIVBY4;
+  if (ctl) {
+    ctl->MS_a = msint;
+    ctl->R_DIV = multisynth.R_DIV;
+    ctl->MS_DIVBY4 = multisynth.MS_DIVBY4;
+  }
+
   // Define clk setting in corresponding CLK structure. Then update the clock
   // Save the current control register value so that can then change drive and phase 
   // on the fly by simply updating the register with corresponding value
   switch (clk) {
     case 0:
       clk0ctl.PLL = pll;
-      clk0ctl.PLLFreq = multisynth.PLL_Fvco;
-      clk0ctl.mAdrive = mAdrive;
+      clk0ctl.PLLFreq = pllfreq;
       clk0ctl.freq = freq;
       clk0ctl.reg = clkreg;
       // See AN619 regarding how phase is calculated.  This defines the max phase allowed.  The register only 
       // allow 127 values and therefore a maximum phase shift is allowed
-      clk0ctl.maxangle = (unsigned int)( SI_PHASE_CONSTANT * (double)freq / (double)multisynth.PLL_Fvco );
+      clk0ctl.maxangle = CalculateMaxAngle (freq, pllfreq);
       multisynth.ClkEnable &= ~SI_ENABLE_CLK0;       // Enable clk0, bit must be cleared to enable
       break;
 
     case 1:
       clk1ctl.PLL = pll;
-      clk1ctl.PLLFreq = multisynth.PLL_Fvco;
-      clk1ctl.mAdrive = mAdrive;
+      clk1ctl.PLLFreq = pllfreq;
       clk1ctl.freq = freq;
       clk1ctl.reg = clkreg;
-      clk1ctl.maxangle = (unsigned int)( SI_PHASE_CONSTANT * (double)freq / (double)multisynth.PLL_Fvco );
+      clk1ctl.maxangle = CalculateMaxAngle (freq, pllfreq);
       multisynth.ClkEnable &= ~SI_ENABLE_CLK1;      // Enable clk1
       break;
 
     case 2:
       clk2ctl.PLL = pll;
-      clk2ctl.PLLFreq = multisynth.PLL_Fvco;
-      clk2ctl.mAdrive = mAdrive;
+      clk2ctl.PLLFreq = pllfreq;
       clk2ctl.freq = freq;
       clk2ctl.reg = clkreg;
-      clk2ctl.maxangle = (unsigned int)( SI_PHASE_CONSTANT * (double)freq / (double)multisynth.PLL_Fvco );
+      clk2ctl.maxangle = CalculateMaxAngle (freq, pllfreq);
       multisynth.ClkEnable &= ~SI_ENABLE_CLK2;      // Enable clk2
       break;
   }
@@ -396,13 +394,81 @@ For clock control register, the bits are as follows
 
   // Calculate the phase and then set the phase register. Note that the PLL must be reset for the phase to take effect.
   // Note phase is defined as degrees however the phase control register uses time based on PLL frequency period
-  UpdatePhase (clk, phase);
-  UpdatePhaseControlRegister (clk);
+  if (ctl) {
+    oldphase = ctl->phase;
+    CalculatePhase (clk, phase);
+    if (oldphase != ctl->phase) resetpll = 1;
+    UpdatePhaseControlRegister (clk);
+  }
+
+  // Reset only the PLL feeding this clock and only when something other than the PLL fraction changed
+  if (resetpll) ResetSi5351PLL (pll);
   
   // The ResetSi5351() routine disables all output clocks and they need to be enabled.  Below enables the specific clock referenced in this routine
   Si5351WriteRegister (SIREG_3_OUTPUT_ENABLE_CTL, multisynth.ClkEnable);
 }
 
+unsigned char FastTuneFrequency (unsigned char clk, char pll, unsigned long freq)
+// This routine retunes a running clock by moving only its PLL.  The output multisynth integer divider (MS_a) and R_DIV
+// are kept so only the PLL fractional P1/P2/P3 registers are written and the PLL is not reset.  This is glitch free.
+// It returns 1 if the clock was retuned and 0 if a full SetupFrequency() is required, i.e.
+//  - fast tune disabled, clock not running, running from another PLL or with a fractional output divider
+//  - another running clock shares the PLL (it would be moved too)
+//  - R_DIV or DIVBY4 would change or the PLL would fall outside 600-900 Mhz with the current divider
+{
+  Si5351_CLK_def *ctl, *other;
+  unsigned long freq_temp;
+  unsigned char i;
+
+  ctl = GetClkControl (clk);
+  if (!fasttune || !ctl || !ctl->MS_a || ctl->PLL != pll) return 0;
+  if (freq > SI_MAX_MS_FREQ || ctl->MS_DIVBY4) return 0;
+
+  // A PLL shared with another running clock cannot be moved
+  for (i = SI_CLK0; i <= SI_CLK2; i++) {
+    other = GetClkControl (i);
+    if (i != clk && other->freq && other->PLL == pll) return 0;
+  }
+
+  // R_DIV must stay the same. ValidateFrequency() also returns the frequency before R_DIV
+  if (freq < SI_MIN_OUT_FREQ) freq = SI_MIN_OUT_FREQ;
+  freq_temp = ValidateFrequency (freq);
+  if (multisynth.R_DIV != ctl->R_DIV) return 0;
+
+  // The PLL frequency with the current divider must still be valid. Divide first to stay inside 32 bits
+  if (freq_temp > SI_MAX_PLL_FREQ / ctl->MS_a) return 0;
+  if (freq_temp * ctl->MS_a < SI_MIN_PLL_FREQ) return 0;
+
+  // Only the PLL feedback divider is written.  The shadow registers drop the bytes that did not change.
+  freq_temp *= ctl->MS_a;
+  SetupSi5351PLL (pll, freq_temp);
+
+  ctl->freq = freq;
+  ctl->PLLFreq = freq_temp;
+  ctl->maxangle = CalculateMaxAngle (freq, freq_temp);
+  return 1;
+}
+
+void Si5351FastTune (unsigned char enable)
+// Enables (1) or disables (0) fast tune.  When disabled every retune uses the full SetupFrequency() path.
+{
+  fasttune = enable;
+}
+
+Si5351_CLK_def *GetClkControl (unsigned char clk)
+// Returns the clock control structure for clk (0, 1, 2) or NULL for an invalid clock
+{
+  switch (clk) {
+    case 0:
+      return &clk0ctl;
+    case 1:
+      return &clk1ctl;
+    case 2:
+      return &clk2ctl;
+  }
+  return NULL;
+}
+
 unsigned long ValidateFrequency (unsigned long freq)
 // This routines determine if the frequency need any special configuration
 // For example frequencies below 500 Khz and above 150 Mhz need special processing to make them work
@@ -450,26 +516,20 @@ unsigned long ValidateFrequency (unsigned long freq)
 }
 
 
-void CalculatePLLFrequency (unsigned long freq)
-// This routine tries to determine the best PLL frequency based on the following conditions (see AN619 for details)
-// 1.  PLL multisynth multipler (a,b,c) must be 24 to 36 (based on 25 Mhz crystal frequency)
-// 2.  Output multisynth divider must be between 8 to 900
-// Bascially the routines scans dividers to generate output from PLL frequency and determine 
-// The best PLL multiplier to use. It prefers whole number (e.g. 24.0, 29.0, 30.0, etc) or numbers closest to whole numbers (24.98, 26.01, etc)
+unsigned long CalculatePLLFrequency (unsigned long freq, Si5351_div_def *ms)
+// This routine returns the PLL frequency and sets the output multisynth divider in ms based on the following conditions (see AN619 for details)
+// 1.  PLL frequency must be 600 to 900 Mhz (i.e. multiplier 24 to 36 based on 25 Mhz crystal frequency)
+// 2.  Output multisynth divider must be an even integer between 8 to 900.  Even integer dividers have the lowest jitter.
+// The range of valid dividers is calculated directly from SI_MIN_PLL_FREQ and SI_MAX_PLL_FREQ so no scan is needed.
+// It prefers a divider that makes the PLL a whole multiple of the crystal (e.g. 24.0, 29.0, 30.0) i.e. integer PLL multiplier.
+// If there is none it uses the even divider that puts the PLL closest to the middle of its range (750 Mhz).  This leaves
+// the most room for FastTuneFrequency() to move the PLL without changing the divider.
+// The cost is 5 32 bit divisions plus GCD() (at most 64 shift/subtract steps) for any frequency.  The old scan tried up to
+// 893 dividers with a double multiply and divide each.  bench times both and counts the scan steps on the host.  Neither
+// has been timed on the ATmega328 so cycle counts for it are estimates from the libgcc routine costs.
 {
-  unsigned long pllmult, freq_temp;               // used to identify pll multiplier as well as actually frequency. See ValidateFrequency()
-  double fraction, minfraction, maxfraction;      // Used to find whole number or numbers closest to whole numbers
-  unsigned int i;
-  unsigned int maxpll, minpll;                    // Used to find whole number or numbers closest to whole numbers
-  unsigned int maxms, minms;                      // Used to find whole number or numbers closest to whole numbers
-
-  // initialize values
-  minfraction = 1;
-  maxfraction = 0;
-  maxpll = 0;
-  minpll = 0;
-  minms = 0;
-  maxms = 0;
+  unsigned long freq_temp;                        // actual frequency to generate before R_DIV. See ValidateFrequency()
+  unsigned long div, minms, maxms, target, step;  // output dividers
 
   // The ValidateFrequency() call checks if frequency is below 1 Mhz or above 100 Mhz or above 150 Mhz.  See note above for frequencies below 1 Mhz or above 150 Mhz.  Frequencies
   // between 100 Mhz and 150 Mhz can be easily done using an integer multipler (i.e. use a fixed multipler of 6 - 6x100 Mhx is 600 Mhz which is inside PLL frequency requirement
@@ -478,81 +538,78 @@ void CalculatePLLFrequency (unsigned long freq)
   // For frequencies above 100 Mhz its easier to deal with because these frequencies are nice integers 
   // for example 100 Mhz x 6 = 600 Mhz, 150 Mhz x 6 = 900 Mhz which fits nicely into the PLL frequency range
   if (freq < 100000000) {
-    // Scan through all possible dividers
-    for (i = 8; i <= 900; i++) {
-      // Calculate the fractional component and the integer component.
-      fraction = (double)(i * (double)freq_temp / multisynth.Fxtal);
-      pllmult = (unsigned long)fraction;                  
-
-      // interger multiplier must be between 24 to 36. These numbers are based on 25 Mhz clock
-      if (pllmult >= (SI_MIN_PLL_FREQ/multisynth.Fxtal) && pllmult <= (SI_MAX_PLL_FREQ/multisynth.Fxtal)) {
-        // Calculate fraction. Do it inside this loop to make processing faster.
-        if (fraction > 1.0) fraction -= pllmult;
-
-        // Check for integer values
-        if (fraction < 0.001) break;
-        if (fraction > 0.9) break;
-        
-        // Check for a 1/2 value
-        if (fraction <= 0.51 and fraction >= 0.49) break;
-        
-        // Check for the max and min values in case a integer cannot be found
-        if (minfraction > fraction) {
-          minfraction = fraction;
-          minpll = pllmult;
-          minms = i;
-        }
-        if (maxfraction < fraction) {
-          maxfraction = fraction;
-          maxpll = pllmult;
-          maxms = i;
-        }
-      // if the multiplier is over 36 (based inb 25 Mhz Xtal) exit loop - we are done
-      } else if (pllmult > (SI_MAX_PLL_FREQ/multisynth.Fxtal)) break;
+    // Even dividers that keep the PLL inside 600 to 900 Mhz. freq_temp is 800 Khz or more so there is always at least one
+    minms = (SI_MIN_PLL_FREQ + freq_temp - 1) / freq_temp;
+    maxms = SI_MAX_PLL_FREQ / freq_temp;
+    if (minms < SI_MSYN_DIV_8) minms = SI_MSYN_DIV_8;
+    if (maxms > SI_MAX_MS_DIV) maxms = SI_MAX_MS_DIV;
+    minms = (minms + 1) & ~1UL;
+    maxms &= ~1UL;
+
+    // Divider that puts the PLL in the middle of its range
+    target = SI_MID_PLL_FREQ / freq_temp;
+
+    // The PLL is a whole multiple of the crystal when the divider is a multiple of Fxtal/gcd(freq_temp, Fxtal).
+    // Use the even multiple closest to the target if one is in range
+    step = multisynth.Fxtal / GCD (freq_temp, multisynth.Fxtal);
+    if (step & 1) step <<= 1;
+    div = ((target + step / 2) / step) * step;
+    if (div < minms) div += step;
+    if (div > maxms && div >= step) div -= step;
+
+    // Could not find a integer so use the even divider closest to the target
+    if (div < minms || div > maxms) {
+      div = (target + 1) & ~1UL;
+      if (div < minms) div = minms;
+      if (div > maxms) div = maxms;
     }
 
   // If frequency is above 100 but below 150 Mhz, can apply a multiplier of 6 - easy case
-  } else if (freq >= 100000000 && freq <= SI_MAX_MS_FREQ) {
-    i = 6;
-    fraction = (double)(i * freq) / (double) multisynth.Fxtal;
-    pllmult = (unsigned long)fraction;
+  } else if (freq <= SI_MAX_MS_FREQ) {
+    div = SI_MSYN_DIV_6;
 
   // if frequency is above 150 Mhz, then can apply multipler of 4 but must use MS_DIVBY4
-  } else if (freq > SI_MAX_MS_FREQ) {
-    i = 4;
-    fraction = (double)(i * freq) / (double) multisynth.Fxtal;
-    pllmult = (unsigned long)fraction;
+  } else {
+    div = SI_MSYN_DIV_4;
     multisynth.MS_DIVBY4 = 0x3;
-
   }
 
-  // Could not find a integer so use biggest or smallest fraction
-  if (pllmult > (SI_MAX_PLL_FREQ/multisynth.Fxtal)) {
-    if ( minfraction < (1.0 - maxfraction) ) {
-      multisynth.PLL_a = minpll;
-      multisynth.MS_a = minms;
-      multisynth.MS_b = 0;
-      multisynth.MS_c = 1;
+  ms->a = div;
+  ms->b = 0;
+  ms->c = 1;
 
-    } else {
-      multisynth.PLL_a = maxpll;
-      multisynth.MS_a = maxms;
-      multisynth.MS_b = 0;
-      multisynth.MS_c = 1;
+  // Calculate PLL frequency based on divider determined.
+  return div * freq_temp;
+}
 
-    }
-    
-  // Integer found!!
-  } else {
-    multisynth.PLL_a = pllmult;
-    multisynth.MS_a = i;
-    multisynth.MS_b = 0;
-    multisynth.MS_c = 1;
-  }
+unsigned long GCD (unsigned long a, unsigned long b)
+// Greatest common divisor using the binary (Stein) algorithm.  Only shifts and subtracts are used which are cheap on AVR
+// compared to 32 bit division.  Takes at most 64 steps for 32 bit numbers.
+{
+  unsigned char shift;
+  unsigned long t;
 
-  // Calculate PLL frequency based on multiplier determined.
-  multisynth.PLL_Fvco = multisynth.MS_a * freq_temp;
+  if (!a) return b;
+  if (!b) return a;
+
+  // Common factors of 2
+  for (shift = 0; !((a | b) & 1); shift++) {
+    a >>= 1;
+    b >>= 1;
+  }
+  while (!(a & 1)) a >>= 1;
+
+  do {
+    while (!(b & 1)) b >>= 1;
+    if (a > b) {
+      t = b;
+      b = a;
+      a = t;
+    }
+    b -= a;
+  } while (b);
 
+  return a << shift;
 }
 
 void UpdateDrive (unsigned char clk, unsigned char idrive)
@@ -590,7 +647,6 @@ void UpdateDrive (unsigned char clk, unsigned char idrive)
   switch (clk) {
     case 0:
       clkreg = clk0ctl.reg;              // Get the old register value
-      clk0ctl.mAdrive = idrive;          // save the current drive value
       clkreg &= SI_CLK_CLR_DRIVE;        // Clear the old mA drive bits in the register
       clkreg |= mAdrive;                 // set the bits for the new mA drive in the register
       clk0ctl.reg = clkreg;              // save the new register for future use
@@ -598,7 +654,6 @@ void UpdateDrive (unsigned char clk, unsigned char idrive)
 
     case 1:
       clkreg = clk1ctl.reg;              // Same comments as above except for clk1
-      clk1ctl.mAdrive = idrive;
       clkreg &= SI_CLK_CLR_DRIVE;
       clkreg |= mAdrive;
       clk1ctl.reg = clkreg;
@@ -606,7 +661,6 @@ void UpdateDrive (unsigned char clk, unsigned char idrive)
 
     case 2:
       clkreg = clk2ctl.reg;              // Same comments as above except for clk2
-      clk2ctl.mAdrive = idrive;
       clkreg &= SI_CLK_CLR_DRIVE;
       clkreg |= mAdrive;
       clk2ctl.reg = clkreg;
@@ -655,7 +709,36 @@ void InvertClk (unsigned char clk, unsigned char invert)
 
 
 void UpdatePhase (unsigned char clk, unsigned int phase)
-// This routing changes the phase of the output frequency
+// This routing changes the phase of the output frequency and resets the PLL feeding the clock so the phase is applied.
+// See CalculatePhase() for how phase is converted to the phase control register value.
+{
+  Si5351_CLK_def *ctl;
+
+  ctl = GetClkControl (clk);
+  if (!ctl) return;
+
+  CalculatePhase (clk, phase);
+
+// Update phase registers based on the defined phase value in clk?ctl.phase 
+  UpdatePhaseControlRegister (clk);
+  
+// Reset the PLL for this clock only.  If PLL not reset, phase is not applied.
+  ResetSi5351PLL (ctl->PLL);
+}
+
+unsigned int CalculateMaxAngle (unsigned long freq, unsigned long pllfreq)
+// This routine returns the maximum phase angle SI_PHASE_CONSTANT * freq / pllfreq (see UpdatePhase()) in integer math.
+// Both frequencies are scaled down together until the product fits in 32 bits which keeps at least 18 significant bits.
+{
+  while (freq > 0xFFFFFFFFUL / SI_PHASE_CONSTANT) {
+    freq >>= 1;
+    pllfreq >>= 1;
+  }
+  return (unsigned int)((SI_PHASE_CONSTANT * freq) / pllfreq);
+}
+
+void CalculatePhase (unsigned char clk, unsigned int phase)
+// This routing converts phase of the output frequency to the phase control register value in clk?ctl.phase
 // Phase shift is based on period of PLL that generates the output frequency.
 // The phase shift register can be 0 to 127 (128 values). Each increment of 1 to the register delays the output by
 // 1/4 of the period of the PLL Clock. For example, is PLL is 900 Mhz, each increment of 1 in register delays 
@@ -689,19 +772,70 @@ void UpdatePhase (unsigned char clk, unsigned int phase)
       } else clk2ctl.phase = clk2ctl.maxangle;
       break;
   }
-
-// Update phase registers based on the defined phase value in clk?ctl.phase 
-  UpdatePhaseControlRegister (clk);
-  
-// Reset PLLA (bit 5 set) & PLLB (bit 7 set)
-// If PLL not reset, phase is not applied.
-  Si5351WriteRegister (SIREG_177_PLL_RESET, SI_PLLA_RESET | SI_PLLB_RESET );
 }
 
 
 
 
+void BestFraction (unsigned long num, unsigned long den, unsigned long *x, unsigned long *y)
+// This routine finds the best rational approximation x/y of num/den (0 <= num < den) with y no bigger than FAREY_N.
+// It gives the same or a closer result than FareyFraction() but walks the continued fraction of num/den instead of
+// single Stern-Brocot steps so it takes O(log FAREY_N) steps (at most about 30) and uses integer arithmetic only.
+// Each continued fraction term jumps over a whole run of Farey mediants.  When the next convergent would have a
+// denominator bigger than FAREY_N, the largest allowed semiconvergent is compared with the last convergent and the closer is used.
+{
+  unsigned long p0, q0, p1, q1, p2, q2;   // convergents p0/q0 (older) and p1/q1 (newer)
+  unsigned long a, t, k;
+  unsigned long long e1, e2;              // |num*q - p*den| error terms
+
+  // Start with 0/1 and 1/0 (infinity)
+  p0 = 0; q0 = 1;
+  p1 = 1; q1 = 0;
+
+  while (den) {
+    // Next continued fraction term.  Stop if its convergent would not fit
+    a = num / den;
+    if (q1 && a > (FAREY_N - q0) / q1) break;
+    p2 = p0 + a * p1;
+    q2 = q0 + a * q1;
+    p0 = p1; q0 = q1;
+    p1 = p2; q1 = q2;
+
+    // Remainder becomes the next fraction
+    t = num - a * den;
+    num = den;
+    den = t;
+  }
+
+  // num/den was exactly representable
+  if (!den) {
+    *x = p1;
+    *y = q1;
+    return;
+  }
+
+  // Largest semiconvergent (p0 + k*p1)/(q0 + k*q1) that fits.  k is less than the term a so k*den < num.
+  k = (FAREY_N - q0) / q1;
+  p2 = p0 + k * p1;
+  q2 = q0 + k * q1;
+
+  // At this point the original fraction is (p1*num + p0*den)/(q1*num + q0*den).  The error of p1/q1 is
+  // den/(q1*(q1*num + q0*den)) and the error of p2/q2 is (num - k*den)/(q2*(q1*num + q0*den)).
+  // The common term cancels so only these products need to be compared.  They fit in 64 bits.
+  e1 = (unsigned long long)den * q2;
+  e2 = (unsigned long long)(num - k * den) * q1;
+
+  if (k && e2 < e1) {
+    *x = p2;
+    *y = q2;
+  } else {
+    *x = p1;
+    *y = q1;
+  }
+}
+
 void FareyFraction (double alpha, unsigned long *x, unsigned long *y)
+// Note: kept for reference.  BestFraction() is used instead as it is much faster.
 // This routine take a decimal number (e.g. 0.5) and generates approprite x, y values to represent the decimal number.
 // For example, if apha is 0.75, then the function set x=3 and y=4 such that x/y = 3/4 = alpha = 0.75 
 // Finds best rational approximation using Farey series. Refer to
@@ -752,58 +886,93 @@ void FareyFraction (double alpha, unsigned long *x, unsigned long *y)
 
 
 
-void CalculateCLKDividers ( void )
-// This routine calculated the output multisynth divider to derive output frequency (multisynth.MS_Fout) from 
-// configured PLL frequency (multisynth.PLL_Fvco). 
-// The function detemines the integer portion of the divider and the decimal portion. The FareyFracion() is used to get 
-// fraction which best represents the decimal number
-// MS_a is the interger portion, MS_b is the numerator for the fractional components, and MS_c is the denominator
+void CalculateCLKDividers (unsigned long pllfreq, unsigned long freq, Si5351_div_def *ms)
+// This routine calculated the output multisynth divider to derive output frequency (freq) from 
+// configured PLL frequency (pllfreq). 
+// The function detemines the integer portion of the divider and the remainder. The BestFraction() is used to get 
+// fraction which best represents the remainder
+// ms->a is the interger portion, ms->b is the numerator for the fractional components, and ms->c is the denominator
 // Note that a, b and C must bit into the register values. See AN619 for details
 {
+  unsigned long remainder;
 
-  double result, fraction;
+  // Strip out the integer portion of the divider and the remainder (i.e. the decimal portion is remainder / freq)
+  ms->a = pllfreq / freq;
+  remainder = pllfreq - ms->a * freq;
 
-  // Determine the divider (floating point number)
-  result = (double) multisynth.PLL_Fvco / (double) multisynth.MS_Fout;
-
-  // Strip out the integer portion
-  multisynth.MS_a = (unsigned long) result;
-  // Stip off the decimal portion
-  fraction = result - multisynth.MS_a;
-
-  // if Fraction is between 0 and 1 (i.e. a decimal number) the get b,c
-  if (fraction < 1.0 && fraction > 0.0) {
-    FareyFraction (fraction, &multisynth.MS_b, &multisynth.MS_c);
+  // if there is a decimal portion get b,c
+  if (remainder) {
+    BestFraction (remainder, freq, &ms->b, &ms->c);
     
   // If fraction is not a decimal, its easy to deal with.
-  // Note a fraction of 1 is silly because, if it was 1, the interger would increment and the decimal would be 0 - Duh!
   } else {
-    multisynth.MS_b = 0;
-    multisynth.MS_c = 1;
+    ms->b = 0;
+    ms->c = 1;
+  }
+
+  // Note a fraction of 1 is silly because, if it was 1, the interger would increment and the decimal would be 0 - Duh!
+  // It can happen when the remainder is very close to freq and must be rolled into the integer
+  if (ms->b >= ms->c) {
+    ms->a++;
+    ms->b = 0;
+    ms->c = 1;
   }
 }
 
-void CalculatePLLDividers (void)
+void CalculatePLLDividers (unsigned long pllfreq, Si5351_div_def *fb)
 // This routine does the exact same thing as CalculateCLKDividers () except its for the PLL Multisynch
 // The only other difference is that the crystal frequency (XTAL) is adjusted based on he correction/calibartion value
-// stored in Arduino eeprom
+// stored in Arduino eeprom.  The correction is in parts per billion.  The PLL multiplier is formed in 64 bit integers:
+//   PLL multiplier = pllfreq / (Fxtal * (1e9 + correction) / 1e9) = (pllfreq * 1e9) / (Fxtal * (1e9 + correction))
+// Both terms fit in 64 bits (9e17 and 2.5e16).  The fraction the Si5351 gets is not exact: BestFraction() is off by less
+// than 1/(c * FAREY_N) and scaling the remainder down to 32 bits for it adds less than 2^-31.  Times Fxtal the worst
+// case (c of 1) is 24 Hz at the PLL for a 25 Mhz crystal.  The output error is the PLL error divided by MS_a * R_DIV.
 {
-  double result, fraction;
-
-  // Calculate the corrected/calibrated crystal frequency that will be used to calculate the PLL frequency
-  multisynth.Fxtalcorr = multisynth.Fxtal + (long) ((double)(multisynth.correction / 10000000.0) * (double) multisynth.Fxtal);
+  unsigned long long num, den;
+  long long remainder;
+  unsigned long xtalcorr, adjust;
+  long correction;
+
+  // Corrected/calibrated crystal frequency to the nearest Hz, in 32 bits.  It is only used for the estimate of fb->a below.
+  // |correction| * Fxtal/1000 fits in 32 bits up to SI_MAX_CORRECTION for crystals up to 42 Mhz
+  correction = multisynth.correction;
+  if (correction > SI_MAX_CORRECTION) correction = SI_MAX_CORRECTION;
+  else if (correction < -SI_MAX_CORRECTION) correction = -SI_MAX_CORRECTION;
+  adjust = ((unsigned long)(correction < 0 ? -correction : correction) * (multisynth.Fxtal / 1000) + 500000) / 1000000;
+  xtalcorr = correction < 0 ? multisynth.Fxtal - adjust : multisynth.Fxtal + adjust;
 
   // From here on the same comments as in CalculateCLKDividers () except its for the PLL Multisynth
-  result = (double) multisynth.PLL_Fvco / (double) multisynth.Fxtalcorr;
-
-  multisynth.PLL_a = (unsigned long) result;
-  fraction = result - multisynth.PLL_a;
+  num = (unsigned long long)pllfreq * SI_PPB;
+  den = (unsigned long long)multisynth.Fxtal * (SI_PPB + multisynth.correction);
+
+  // The 32 bit estimate using the rounded xtalcorr is at most 1 out.  Fix it with 64 bit adds instead of a 64 bit divide.
+  fb->a = pllfreq / xtalcorr;
+  remainder = (long long)(num - (unsigned long long)fb->a * den);
+  while (remainder < 0) {
+    fb->a--;
+    remainder += den;
+  }
+  while ((unsigned long long)remainder >= den) {
+    fb->a++;
+    remainder -= den;
+  }
 
-  if (fraction < 1.0 && fraction > 0.0) {
-    FareyFraction (fraction, &multisynth.PLL_b, &multisynth.PLL_c);
+  if (remainder) {
+    // Scale remainder/den down until it fits the 32 bit BestFraction()
+    while (den > 0xFFFFFFFFULL) {
+      den >>= 1;
+      remainder >>= 1;
+    }
+    BestFraction ((unsigned long)remainder, (unsigned long)den, &fb->b, &fb->c);
   } else {
-    multisynth.PLL_b = 0;
-    multisynth.PLL_c = 1;
+    fb->b = 0;
+    fb->c = 1;
+  }
+
+  if (fb->b >= fb->c) {
+    fb->a++;
+    fb->b = 0;
+    fb->c = 1;
   }
 }
 
@@ -849,20 +1018,104 @@ void UpdatePhaseControlRegister (unsigned char clk)
   }
 }
 
+void EncodeMultisynth (unsigned long P1, unsigned long P2, unsigned long P3)
+// This routine packs P1, P2 and P3 into the 8 register layout shared by the PLL (MSNA/MSNB) and output (MS0-MS2) multisynths.
+// The result is left in msregs[] ready to be sent with Si5351WriteRegisters().  See AN619 for the register layout.
+{
+  msregs[0] = (P3 & 0x0000FF00) >> 8;
+  msregs[1] = (P3 & 0x000000FF);
+  msregs[2] = (P1 & 0x00030000) >> 16;
+  msregs[3] = (P1 & 0x0000FF00) >> 8;
+  msregs[4] = (P1 & 0x000000FF);
+  msregs[5] = ((P3 & 0x000F0000) >> 12) | ((P2 & 0x000F0000) >> 16);
+  msregs[6] = (P2 & 0x0000FF00) >> 8;
+  msregs[7] = (P2 & 0x000000FF);
+}
+
+void EncodeDivider (unsigned long a, unsigned long b, unsigned long c)
+// Converts the divider a + b/c to P1, P2 and P3 (AN619) and packs them with EncodeMultisynth()
+{
+  unsigned long temp;
+
+  temp = (128 * b) / c;                 // 128 * b first to keep the most accurate integer value
+  EncodeMultisynth (128 * a + temp - 512, 128 * b - c * temp, c);
+}
+
 void Si5351WriteRegister (unsigned char reg, unsigned char value)
 // Routine uses the I2C protcol to write data to the Si5351 register.
+// The write is skipped if the shadow shows the register already holds value.
 {
-  Wire.begin();
-  Wire.beginTransmission(SI5351_ADDRESS);
-  Wire.write(reg);
-  Wire.write(value);
-  Wire.endTransmission();
+  Si5351WriteRegisters (reg, &value, 1);
+}
+
+void Si5351WriteRegisters (unsigned char reg, unsigned char *data, unsigned char len)
+// Routine writes len consecutive registers starting at reg.  Each byte is compared with the shadow and only
+// bytes that changed are sent.  Changed bytes are coalesced into runs and each run is one auto increment I2C burst.
+// Unchanged gaps of up to SI_SHADOW_GAP bytes are sent inside the run as it costs less than starting a new transaction.
+// Registers that are not shadowed (e.g. PLL reset) are always sent.
+// The shadow is only updated once a run has been sent.  A run the Si5351 did not acknowledge is marked unknown so the
+// next write of those registers goes out again.
+{
+  unsigned char i, start, end, idx;
+
+  i = 0;
+  while (i < len) {
+    // Skip over bytes the Si5351 already has
+    if (!Si5351ShadowChanged (reg + i, data[i])) {
+      si5351stats.skipped++;
+      i++;
+      continue;
+    }
+
+    // Extend the run while there are changed bytes close enough to be worth including
+    start = i;
+    end = i;
+    for (i++; i < len && (i - end) <= (SI_SHADOW_GAP + 1); i++) {
+      if (Si5351ShadowChanged (reg + i, data[i])) end = i;
+    }
+    i = end + 1;
+
+    // Send the run then record it in the shadow.  If it failed the chip may hold any part of it
+    if (Si5351SendRegisters (reg + start, &data[start], end - start + 1)) {
+      for (idx = start; idx <= end; idx++) Si5351ShadowClear (reg + idx);
+    } else {
+      for (idx = start; idx <= end; idx++) Si5351ShadowStore (reg + idx, data[idx]);
+    }
+  }
+}
+
+unsigned char Si5351SendRegisters (unsigned char reg, unsigned char *data, unsigned char len)
+// Routine writes len consecutive registers starting at reg with no shadow check.  The Si5351 auto increments the register
+// address so a whole parameter block goes out in a single start/address/stop I2C transaction.
+// Blocks longer than the Wire buffer are split into several transactions.
+// Returns 0 if every transaction was acknowledged, otherwise the Wire.endTransmission() error of the one that failed.
+// Nothing after a failed transaction is sent.
+// Note that Wire.begin() is called once by ResetSi5351() and not for every write.
+{
+  unsigned char i, n, status;
+
+  while (len) {
+    n = (len > SI_I2C_MAXBURST) ? SI_I2C_MAXBURST : len;
+    Wire.beginTransmission(SI5351_ADDRESS);
+    Wire.write(reg);
+    for (i = 0; i < n; i++) Wire.write(data[i]);
+    status = Wire.endTransmission();
+    si5351stats.bursts++;
+    if (status) {
+      si5351stats.errors++;
+      return status;
+    }
+    si5351stats.writes += n;
+    reg += n;
+    data += n;
+    len -= n;
+  }
+  return 0;
 }
 
 unsigned char Si5351ReadRegister (unsigned char reg)
 // This function uses I2C protocol to read data from Si5351 register. The result read is returned
 {
-  Wire.begin();
   Wire.beginTransmission(SI5351_ADDRESS);
   Wire.write(reg);
   Wire.endTransmission();
@@ -871,3 +1124,92 @@ unsigned char Si5351ReadRegister (unsigned char reg)
 
   return Wire.read();
 }
+
+void Si5351ReadRegisters (unsigned char reg, unsigned char *data, unsigned char len)
+// This function reads len consecutive registers starting at reg using the Si5351 auto increment.
+{
+  unsigned char i, n;
+
+  while (len) {
+    n = (len > SI_I2C_MAXBURST) ? SI_I2C_MAXBURST : len;
+    Wire.beginTransmission(SI5351_ADDRESS);
+    Wire.write(reg);
+    Wire.endTransmission();
+
+    Wire.requestFrom(SI5351_ADDRESS, n);
+    for (i = 0; i < n; i++) data[i] = Wire.read();
+    reg += n;
+    data += n;
+    len -= n;
+  }
+}
+
+unsigned char Si5351ShadowIndex (unsigned char reg)
+// Maps a Si5351 register to its slot in si5351shadow[].  Registers 16-65 (clock control and all multisynths)
+// map directly, followed by register 3, the phase offsets 165-167 and the load capacitance 183.
+// SI_SHADOW_NONE is returned for registers that are not shadowed.
+{
+  if (reg >= SIREG_16_CLK0_CTL && reg <= SIREG_65_MSYN2_8) return reg - SIREG_16_CLK0_CTL;
+  if (reg == SIREG_3_OUTPUT_ENABLE_CTL) return SI_SHADOW_REG3;
+  if (reg >= SIREG_165_CLK0_PHASE_OFFSET && reg <= SIREG_167_CLK2_PHASE_OFFSET) return SI_SHADOW_PHASE + reg - SIREG_165_CLK0_PHASE_OFFSET;
+  if (reg == SIREG_183_CRY_LOAD_CAP) return SI_SHADOW_REG183;
+  return SI_SHADOW_NONE;
+}
+
+unsigned char Si5351ShadowChanged (unsigned char reg, unsigned char value)
+// Returns non zero if value must be sent to the Si5351 i.e. register not shadowed, shadow not valid or value different
+{
+  unsigned char idx;
+
+  idx = Si5351ShadowIndex (reg);
+  if (idx == SI_SHADOW_NONE) return 1;
+  if (!(si5351valid[idx >> 3] & (1 << (idx & 7)))) return 1;
+  return si5351shadow[idx] != value;
+}
+
+void Si5351ShadowStore (unsigned char reg, unsigned char value)
+// Records value in the shadow and marks the entry valid
+{
+  unsigned char idx;
+
+  idx = Si5351ShadowIndex (reg);
+  if (idx == SI_SHADOW_NONE) return;
+  si5351shadow[idx] = value;
+  si5351valid[idx >> 3] |= (1 << (idx & 7));
+}
+
+void Si5351ShadowClear (unsigned char reg)
+// Marks one shadow entry as unknown so the next write to reg is sent
+{
+  unsigned char idx;
+
+  idx = Si5351ShadowIndex (reg);
+  if (idx == SI_SHADOW_NONE) return;
+  si5351valid[idx >> 3] &= ~(1 << (idx & 7));
+}
+
+void Si5351InvalidateShadow (void)
+// Marks every shadow entry as unknown.  The next write to each register will be sent to the Si5351.
+// Use this if the Si5351 may have been changed behind these routines (e.g. power glitch or another I2C master).
+{
+  memset (si5351valid, 0, sizeof(si5351valid));
+}
+
+void Si5351SyncShadow (void)
+// Reads the shadowed registers back from the Si5351 so the shadow matches the chip
+{
+  unsigned char i;
+
+  Si5351ReadRegisters (SIREG_16_CLK0_CTL, si5351shadow, SIREG_65_MSYN2_8 - SIREG_16_CLK0_CTL + 1);
+  si5351shadow[SI_SHADOW_REG3] = Si5351ReadRegister (SIREG_3_OUTPUT_ENABLE_CTL);
+  Si5351ReadRegisters (SIREG_165_CLK0_PHASE_OFFSET, &si5351shadow[SI_SHADOW_PHASE], 3);
+  si5351shadow[SI_SHADOW_REG183] = Si5351ReadRegister (SIREG_183_CRY_LOAD_CAP);
+
+  for (i = 0; i < SI_SHADOW_REGS; i++) si5351valid[i >> 3] |= (1 << (i & 7));
+}
+
+void Si5351ClearStats (void)
+// Zero the I2C write statistics
+{
+  memset ((char *)&si5351stats, 0, sizeof(si5351stats));
+}
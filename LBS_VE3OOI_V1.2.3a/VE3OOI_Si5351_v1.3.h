@@ -8,48 +8,87 @@
 #define SI5351_ADDRESS (0x60) 
 #define I2C_READBIT (0x01)
 #define FAREY_N	1048575
+#define SI_I2C_CLOCK 400000          // Si5351 supports fast mode I2C.  4x faster retunes than the 100 kHz default
+#define SI_I2C_MAXBURST 31          // Wire library buffer is 32 bytes, one is used by the register address
+
+// Shadow register layout.  See Si5351ShadowIndex()
+#define SI_SHADOW_REG3   50         // Registers 16-65 use slots 0-49
+#define SI_SHADOW_PHASE  51         // Registers 165-167
+#define SI_SHADOW_REG183 54
+#define SI_SHADOW_REGS   55
+#define SI_SHADOW_NONE   0xFF
+#define SI_SHADOW_GAP    2          // Unchanged bytes allowed inside a burst before it is split in two
 
 typedef struct {
 	char PLL;
-	unsigned long Fxtal, Fxtalcorr, PLL_Fvco, MS_Fout;
- 	unsigned long PLL_a, PLL_b, PLL_c;
-	unsigned long MSN_P1, MSN_P2, MSN_P3;
-	unsigned long MS_a, MS_b, MS_c;
-	unsigned long MS_P1, MS_P2, MS_P3;
-        unsigned int R_DIV;
+	unsigned long Fxtal;
+        unsigned char R_DIV;
         unsigned char MS_DIVBY4;
         unsigned char ClkEnable;
-        long int correction;   // can be + or -
+        long int correction;   // parts per billion, can be + or -
 } Si5351_def;
 
+typedef struct {
+        unsigned long a, b, c;      // Multisynth divider a + b/c.  Only lives on the stack while a clock is retuned
+} Si5351_div_def;
+
+typedef struct {
+        unsigned long writes;     // Register bytes sent to the Si5351
+        unsigned long skipped;    // Register bytes not sent because the shadow already matched
+        unsigned long bursts;     // I2C write transactions
+        unsigned long errors;     // I2C write transactions the Si5351 did not acknowledge
+} Si5351_stats_def;
+
 typedef struct {
 	char PLL;
-	unsigned char mAdrive;
         unsigned char phase;
         unsigned int maxangle;
-        unsigned char reg;
+        unsigned char reg;          // Clock control register.  The drive strength is in its low 2 bits
         unsigned long freq;
         unsigned long PLLFreq;
+        unsigned int MS_a;          // Output multisynth divider the clock is running with if it is a whole number (0 if not running or fractional)
+        unsigned char R_DIV : 3;
+        unsigned char MS_DIVBY4 : 2;
 } Si5351_CLK_def;
 
 void ResetSi5351 (unsigned int loadcap);
-void SetupSi5351PLL (char pll);
+void SetupSi5351PLL (char pll, unsigned long pllfreq);
+void ResetSi5351PLL (char pll);
 void SetFrequency (unsigned char src, char pll, unsigned long freq, unsigned char mAdrive);
 void SetupFrequency (unsigned char clk, char pll, unsigned long pllfreq, unsigned long freq, unsigned int phase, unsigned char mAdrive);
-void CalculatePLLFrequency (unsigned long freq);
+unsigned long CalculatePLLFrequency (unsigned long freq, Si5351_div_def *ms);
+unsigned long GCD (unsigned long a, unsigned long b);
 unsigned long ValidateFrequency (unsigned long freq);
+unsigned char FastTuneFrequency (unsigned char clk, char pll, unsigned long freq);
+void Si5351FastTune (unsigned char enable);
+Si5351_CLK_def *GetClkControl (unsigned char clk);
 
 void UpdateClkControlRegister (unsigned char clk);
 void UpdatePhaseControlRegister (unsigned char clk);
 void UpdateDrive (unsigned char clk, unsigned char idrive);
 void UpdatePhase (unsigned char clk, unsigned int phase);
+void CalculatePhase (unsigned char clk, unsigned int phase);
+unsigned int CalculateMaxAngle (unsigned long freq, unsigned long pllfreq);
 void InvertClk (unsigned char clk, unsigned char invert);
 
 void Si5351WriteRegister (unsigned char reg, unsigned char value);
+void Si5351WriteRegisters (unsigned char reg, unsigned char *data, unsigned char len);
+unsigned char Si5351SendRegisters (unsigned char reg, unsigned char *data, unsigned char len);
+void Si5351ReadRegisters (unsigned char reg, unsigned char *data, unsigned char len);
+unsigned char Si5351ShadowIndex (unsigned char reg);
+unsigned char Si5351ShadowChanged (unsigned char reg, unsigned char value);
+void Si5351ShadowStore (unsigned char reg, unsigned char value);
+void Si5351ShadowClear (unsigned char reg);
+void Si5351InvalidateShadow (void);
+void Si5351SyncShadow (void);
+void Si5351ClearStats (void);
+void EncodeMultisynth (unsigned long P1, unsigned long P2, unsigned long P3);
+void EncodeDivider (unsigned long a, unsigned long b, unsigned long c);
 unsigned char Si5351ReadRegister (unsigned char reg);
-void CalculateCLKDividers (void);
+void CalculateCLKDividers (unsigned long pllfreq, unsigned long freq, Si5351_div_def *ms);
 void FareyFraction (double alpha, unsigned long *x, unsigned long *y);
-void CalculatePLLDividers (void);
+void BestFraction (unsigned long num, unsigned long den, unsigned long *x, unsigned long *y);
+void CalculatePLLDividers (unsigned long pllfreq, Si5351_div_def *fb);
 
 
 #define SI_CLK0  0
@@ -134,8 +173,12 @@ void CalculatePLLDividers (void);
 #define SI_CRY_FREQ_25MHZ   	25000000
 #define SI_CRY_FREQ_27MHZ   	27000000
 
+#define SI_PPB                  1000000000L   // Crystal correction is in parts per billion
+#define SI_MAX_CORRECTION       100000L       // +/- 100 ppm
+
 #define SI_MAX_PLL_FREQ   	900000000
 #define SI_MIN_PLL_FREQ   	600000000
+#define SI_MID_PLL_FREQ   	750000000
 #define SI_AUTO_PLL_FREQ        0
 
 #define SI_MAX_OUT_FREQ   	160000000
@@ -145,6 +188,7 @@ void CalculatePLLDividers (void);
 #define SI_MSYN_DIV_4    	4
 #define SI_MSYN_DIV_6    	6
 #define SI_MSYN_DIV_8    	8
+#define SI_MAX_MS_DIV    	900
 
 #define SI_PHASE_CONSTANT   	11430      // This is 127 x 360 / 4 (127 is the max value allowed in phase register)
 
@@ -172,8 +216,8 @@ void CalculatePLLDividers (void);
 #define SI_CLK_CLR_DRIVE        B11111100
 
 	
-#define SI_PLLA_RESET		B10000000
-#define SI_PLLB_RESET		B00100000
+#define SI_PLLA_RESET		B00100000
+#define SI_PLLB_RESET		B10000000
 
 #endif // _Si5351_H_
 
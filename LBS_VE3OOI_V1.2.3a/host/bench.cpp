@@ -0,0 +1,261 @@
+/*
+ * Microbenchmark for the host build.  Reports ns/call and the bus traffic per call
+ * (I2C bytes to the Si5351, SPI bytes to the display) for the hot paths of the radio.
+ *
+ *   ./bench [iterations]
+ *
+ * Exits 1 if a settings save or memory channel write waits for the EEPROM.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "Adafruit_PCD8544.h"
+#include "VE3OOI_Si5351_v1.3.h"
+#include "LBS_VE3OOI_V1.3.h"
+#include "Skinny_UART.h"
+#include "Skinny_CAT.h"
+#include "Skinny_TX.h"
+#include "Skinny_Scan.h"
+#include "Skinny_Scope.h"
+#include "Skinny_EEPROM.h"
+#include "EEPROM.h"
+#include "Rotary.h"
+
+extern Si5351_def multisynth;
+extern int_fast32_t rx;
+extern unsigned char renderflags;
+extern unsigned long frametime;
+extern lbs_struture lbsmem;
+
+static volatile unsigned long sink;
+
+static double now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void report (const char *name, unsigned long calls, double ns, unsigned long i2c, unsigned long spi)
+{
+  printf ("%-28s %10lu %12.1f %10.1f %10.1f\n", name, calls, ns / calls, (double)i2c / calls, (double)spi / calls);
+}
+
+static unsigned long ScanPLLPlan (unsigned long freq)
+// The 8 to 900 divider scan CalculatePLLFrequency() used before the direct plan.  Kept here only to time against it.
+// Returns the number of dividers tried.  Each one is a double multiply, divide and compare (soft float on the ATmega328)
+{
+  unsigned long pllmult, freq_temp = ValidateFrequency (freq);
+  double fraction;
+  unsigned int i;
+
+  if (freq >= 100000000) return 0;
+  for (i = 8; i <= 900; i++) {
+    fraction = (double)(i * (double)freq_temp / multisynth.Fxtal);
+    pllmult = (unsigned long)fraction;
+    if (pllmult >= (SI_MIN_PLL_FREQ/multisynth.Fxtal) && pllmult <= (SI_MAX_PLL_FREQ/multisynth.Fxtal)) {
+      if (fraction > 1.0) fraction -= pllmult;
+      if (fraction < 0.001 || fraction > 0.9) break;
+      if (fraction <= 0.51 && fraction >= 0.49) break;
+    } else if (pllmult > (SI_MAX_PLL_FREQ/multisynth.Fxtal)) break;
+  }
+  return i - 7;
+}
+
+#define BENCH(name, calls, body) do {                                   \
+    unsigned long i2c = Wire.bytes, spi = host_spi_bytes;               \
+    double t = now_ns ();                                               \
+    for (unsigned long n = 0; n < (calls); n++) { body; }               \
+    t = now_ns () - t;                                                  \
+    report (name, calls, t, Wire.bytes - i2c, host_spi_bytes - spi);    \
+  } while (0)
+
+int main (int argc, char **argv)
+{
+  unsigned long iterations = (argc > 1) ? strtoul (argv[1], NULL, 10) : 100000;
+  unsigned long x, y;
+  Si5351_div_def div;
+  unsigned char failed = 0;
+  char cmd[32];
+
+  if (!iterations) iterations = 1;
+
+  HostSerialEcho (0);
+  setup ();
+
+  printf ("%-28s %10s %12s %10s %10s\n", "function", "calls", "ns/call", "I2C B/call", "SPI B/call");
+
+  // Tuning steps of 10 Hz around 7.1 MHz as the encoder would produce
+  Si5351FastTune (1);
+  BENCH ("SetFrequency fast tune", iterations,
+         SetFrequency (SI_CLK0, SI_PLL_A, 7100000 + (n & 0xFF) * 10, SI_CLK_8MA));
+
+  // Band changes always need a new PLL plan
+  Si5351FastTune (0);
+  BENCH ("SetFrequency band change", iterations,
+         SetFrequency (SI_CLK0, SI_PLL_A, (n & 1) ? 3500000 + (n & 0xFF) * 10 : 14000000 + (n & 0xFF) * 10, SI_CLK_8MA));
+  Si5351FastTune (1);
+
+  BENCH ("FareyFraction", iterations / 10,
+         FareyFraction ((double)(n % 1000003) / 1000003.0, &x, &y); sink += x + y);
+
+  BENCH ("BestFraction", iterations,
+         BestFraction (n % 1000003, 1000003, &x, &y); sink += x + y);
+
+  BENCH ("CalculatePLLFrequency", iterations,
+         sink += CalculatePLLFrequency (8000 + n * 1597 % 159992000, &div) + div.a);
+
+  // x86 does double in hardware so the time above hides most of the difference.  The number of scan steps is
+  // what matters on the AVR, where each one is a few thousand cycles of soft float
+  unsigned long steps, scansum = 0, scanmax = 0;
+  BENCH ("PLL plan by scan (old)", iterations / 10,
+         steps = ScanPLLPlan (8000 + n * 1597 % 159992000); scansum += steps; if (steps > scanmax) scanmax = steps);
+
+  BENCH ("ParseSerial", iterations,
+         strcpy (cmd, "cs -6000 7100000"); sink += ParseSerial (cmd));
+
+  // A CAT program polling and setting the frequency.  Each call is one command, fed a byte at a time
+  static const char *cat[2] = {"FA;", "FA00007100000;"};
+  BENCH ("CatInput FA poll/set", iterations,
+         for (const char *c = cat[n & 1]; *c; c++) CatInput (*c));
+
+  // Encoder decode as done in the pin change ISR.  The pins follow a quadrature sequence
+  static const unsigned char quad[4] = {0, 1, 3, 2};
+  Rotary slow (2, 3);
+  RotaryFast<2, 3> fast;
+  BENCH ("Rotary::process", iterations,
+         host_pins[2] = quad[n & 3] & 1; host_pins[3] = quad[n & 3] >> 1; sink += slow.process ());
+  BENCH ("RotaryFast::process", iterations,
+         host_pins[2] = quad[n & 3] & 1; host_pins[3] = quad[n & 3] >> 1; sink += fast.process ());
+  host_pins[2] = host_pins[3] = 1;
+
+  // One pass of the main loop with the encoder moving every pass and with the knob still
+  BENCH ("loop tuning", iterations / 10,
+         rx = DEFAULT_RX_FREQ + (n & 0x3F) * 100; loop ());
+  BENCH ("loop idle", iterations / 10, loop ());
+
+  // One frame with the frequency and S meter changed
+  BENCH ("RenderScreen", iterations / 10,
+         rx = DEFAULT_RX_FREQ + (n & 0x3F) * 100; renderflags = RENDER_FREQ | RENDER_SMETER;
+         frametime = millis () - FRAME_TIME; RenderScreen ());
+
+  printf ("\nPLL plan by scan (old): %.1f dividers tried per plan, worst %lu\n",
+          (double)scansum / (iterations / 10 ? iterations / 10 : 1), scanmax);
+
+  // Console H (help) command.  Time loop() is held up by Serial.write() waiting for the TX buffer and the
+  // loop passes it takes for the whole message to go out at SERIAL_BAUD
+  {
+    unsigned long long blocked = host_serial_blocked_us;
+    unsigned long tx = host_serial_tx_bytes, passes = 0;
+
+    Serial.flush ();
+    strcpy (cmd, "H");
+    ExecuteSerial (cmd);
+    // A pass of loop() takes in the order of 100 us on the ATmega328 so let that much time go by per pass
+    for (; passes < 1000000 && (TxPending () || Serial.availableForWrite () < 63); passes++) {
+      loop ();
+      delayMicroseconds (100);
+    }
+    printf ("\nH command: %lu bytes at %d baud, loop() blocked %llu us, %lu loop passes to send\n",
+            host_serial_tx_bytes - tx, SERIAL_BAUD, host_serial_blocked_us - blocked, passes);
+  }
+
+  // Table replies longer than the TX queue, typed at the console.  loop() must not wait for any of them
+  {
+    static const char *replies[] = {"D\r", "SL\r", "P\r", "T\r"};
+    unsigned long long blocked;
+    unsigned long passes;
+    unsigned char r;
+
+    printf ("Long replies, loop() blocked:");
+    for (r = 0; r < sizeof(replies) / sizeof(replies[0]); r++) {
+      blocked = host_serial_blocked_us;
+      HostSerialInput (replies[r]);
+      for (passes = 0; passes < 1000000 && (passes < 10 || TxBusy () || TxPending ()); passes++) {
+        loop ();
+        delayMicroseconds (100);
+      }
+      printf (" %.*s %llu us", (int)strlen (replies[r]) - 1, replies[r], host_serial_blocked_us - blocked);
+    }
+    printf ("\n");
+  }
+
+  // Range scan with no signal.  Channels per second in loop() passes of about 100 us as above
+  {
+    Skinny_Scan_stats_def scan;
+    unsigned long passes;
+    unsigned long long wall = now_ns ();
+
+    ScanRange (7001000, 7300000, 1000);
+    for (passes = 0; passes < 100000; passes++) {
+      loop ();
+      delayMicroseconds (100);
+    }
+    ScanStop ();
+    ScanStats (&scan);
+    wall = now_ns () - wall;
+    printf ("Scan: %lu channels in %lu ms, %.1f ch/s, settle %d ms, %.1f us host time per channel\n", scan.channels, scan.elapsed,
+            scan.elapsed ? 1000.0 * scan.channels / scan.elapsed : 0.0, scansettle, scan.channels ? wall / 1000.0 / scan.channels : 0.0);
+  }
+
+  // Bandscope sweeps with the same loop() pass time
+  {
+    Skinny_Scope_stats_def scope;
+    unsigned long passes;
+
+    startScope (0);
+    for (passes = 0; passes < 100000; passes++) {
+      loop ();
+      delayMicroseconds (100);
+    }
+    ScopeStats (&scope);
+    stopScope ();
+    printf ("Bandscope: %lu sweeps of %d points, %lu ms per sweep, %.1f sweeps/s\n", scope.sweeps, SCOPE_POINTS, (unsigned long)scope.sweepms,
+            scope.sweepms ? 1000.0 / scope.sweepms : 0.0);
+  }
+
+  // Settings saves as the save task does them, each with the EEPROM idle, and memory channel writes (SW) back to back.
+  // Time they hold up loop() waiting for the EEPROM (a full queue or a byte being programmed) and time interrupts
+  // are off waiting for a byte to be programmed (encoder edges, serial bytes and millis() ticks are lost).
+  // Neither may wait at all
+  {
+    unsigned long long irqoff = host_eeprom_irqoff_us, waited, blocked = 0, worst = 0;
+    unsigned long writes = EEPROM.writes, bad = host_eeprom_bad_reads, saves;
+
+    EEFlush ();
+    for (saves = 0; saves < 20; saves++) {
+      lbsmem.rx += 100;
+      waited = host_wait_us;
+      EEJournalSave (&lbsmem, sizeof(lbsmem));
+      waited = host_wait_us - waited;
+      blocked += waited;
+      if (waited > worst) worst = waited;
+      EEFlush ();
+    }
+    printf ("Settings save: %lu saves, %.1f bytes programmed per save, loop() blocked %llu us mean %llu us worst, "
+            "interrupts off %llu us, %lu bad reads\n", saves, (double)(EEPROM.writes - writes) / saves, blocked / saves, worst,
+            host_eeprom_irqoff_us - irqoff, host_eeprom_bad_reads - bad);
+    if (blocked || host_eeprom_irqoff_us != irqoff) {
+      printf ("FAILED: a settings save waited for the EEPROM\n");
+      failed = 1;
+    }
+
+    writes = EEPROM.writes;
+    waited = host_wait_us;
+    for (saves = 0; saves < SCAN_CHANNELS; saves++) ScanChannelWrite (saves, 7000000 + saves * 5000);
+    waited = host_wait_us - waited;
+    EEFlush ();
+    printf ("Channel write: %d channels back to back, %lu bytes programmed, loop() blocked %llu us\n", SCAN_CHANNELS,
+            EEPROM.writes - writes, waited);
+    if (waited) {
+      printf ("FAILED: a memory channel write waited for the EEPROM\n");
+      failed = 1;
+    }
+  }
+
+  return failed;
+}
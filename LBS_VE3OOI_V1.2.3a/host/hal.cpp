@@ -0,0 +1,548 @@
+/*
+ * Host implementation of the Arduino stand-ins in include/.
+ * Time is real time plus whatever delay() has skipped so delays do not slow the host down.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "EEPROM.h"
+#include "Adafruit_PCD8544.h"
+#include "toneAC.h"
+
+#define SI5351_HOST_ADDRESS 0x60
+
+// AVR registers
+volatile uint8_t PCICR;
+volatile uint8_t PCMSK2;
+volatile uint8_t SREG = 0x80;       // Interrupts on, as after init() in the Arduino core
+volatile uint8_t ADMUX;
+volatile uint8_t ADCSRA;
+volatile uint8_t ADCSRB;
+volatile uint16_t ADC;
+volatile uint8_t host_eecr;
+volatile uint8_t host_eedr;
+volatile uint16_t EEAR;
+
+// Pins and analog input
+unsigned char host_pins[NUM_HOST_PINS] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+int (*host_analog_source) (uint8_t pin);
+
+void pinMode (uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite (uint8_t pin, uint8_t val)
+{
+  if (pin < NUM_HOST_PINS) host_pins[pin] = val ? 1 : 0;
+}
+
+int digitalRead (uint8_t pin)
+{
+  return (pin < NUM_HOST_PINS) ? host_pins[pin] : LOW;
+}
+
+uint8_t HostReadPort (uint8_t port)
+{
+  static const uint8_t first[3] = {0, 8, 14}, count[3] = {8, 6, 6};
+  uint8_t i, value = 0;
+
+  for (i = 0; i < count[port]; i++) value |= host_pins[first[port] + i] << i;
+  return value;
+}
+
+int analogRead (uint8_t pin)
+{
+  if (host_analog_source) return host_analog_source (pin);
+  return 100 + (rand () & 0x3F);
+}
+
+void analogWrite (uint8_t pin, int val)
+{
+}
+
+// Time
+static unsigned long long host_skipped_us;
+unsigned long long host_wait_us;
+
+static unsigned long long host_now_us (void)
+{
+  static struct timespec start;
+  struct timespec now;
+
+  if (!start.tv_sec && !start.tv_nsec) clock_gettime (CLOCK_MONOTONIC, &start);
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (unsigned long long)(now.tv_sec - start.tv_sec) * 1000000ULL + (now.tv_nsec - start.tv_nsec) / 1000 + host_skipped_us;
+}
+
+static void host_run_adc (unsigned long long now);
+static void host_run_eeprom (unsigned long long now);
+static void host_run_serial (unsigned long long now);
+
+// Background hardware (ADC, EEPROM) catches up whenever the sketch looks at the time or waits
+static unsigned long long host_run (void)
+{
+  unsigned long long now = host_now_us ();
+
+  host_run_adc (now);
+  host_run_eeprom (now);
+  host_run_serial (now);
+  return now;
+}
+
+unsigned long millis (void)
+{
+  return (unsigned long)(host_run () / 1000);
+}
+
+unsigned long micros (void)
+{
+  return (unsigned long)host_run ();
+}
+
+void delay (unsigned long ms)
+{
+  host_skipped_us += (unsigned long long)ms * 1000;
+  host_wait_us += (unsigned long long)ms * 1000;
+  host_run ();
+}
+
+void delayMicroseconds (unsigned int us)
+{
+  host_skipped_us += us;
+  host_wait_us += us;
+  host_run ();
+}
+
+// Free running ADC.  Conversions that would have completed since the last call to millis()/micros()
+// are delivered to ADC_vect (up to about 10 s worth at a time).  ADC_vect is weak so programs
+// without an ADC ISR still link
+extern "C" void ADC_vect (void) __attribute__((weak));
+
+static void host_run_adc (unsigned long long now)
+{
+  static unsigned long long last;
+  unsigned long long period, n;
+
+  if ((ADCSRA & (_BV(ADEN) | _BV(ADATE) | _BV(ADIE))) != (_BV(ADEN) | _BV(ADATE) | _BV(ADIE)) || !ADC_vect) {
+    last = now;
+    return;
+  }
+
+  // Held until interrupts are on again
+  if (!(SREG & 0x80)) return;
+
+  // 13 ADC clocks per conversion, prescaler is 2^ADPS (0 is 2)
+  period = 13ULL * ((ADCSRA & 0x7) ? (1 << (ADCSRA & 0x7)) : 2) * 1000000ULL;
+  n = (now - last) * F_CPU / period;
+  if (!n) return;
+  last += n * period / F_CPU;
+  if (n > 100000) n = 100000;
+
+  while (n--) {
+    ADC = analogRead (A0 + (ADMUX & 0x7)) & 0x3FF;
+    ADC_vect ();
+  }
+}
+
+// EEPROM ready interrupt.  A byte started by EE_READY_vect (EEPE set) is programmed HOST_EEPROM_WRITE_US later,
+// then the ISR is called again for the next one while EERIE is set and interrupts are on.  If the ISR returns without
+// starting a byte (it dropped one the EEPROM already holds) it is called again at once as on the AVR.
+// EE_READY_vect is weak like ADC_vect
+#define HOST_EEPROM_WRITE_US 3400
+
+extern "C" void EE_READY_vect (void) __attribute__((weak));
+
+static unsigned long long host_eeprom_done;     // When the byte being programmed is done
+unsigned long long host_eeprom_irqoff_us;
+unsigned long host_eeprom_bad_reads;
+
+static void host_run_eeprom (unsigned long long now)
+{
+  unsigned long long start = now;
+
+  for (;;) {
+    if (host_eecr & _BV(EEPE)) {
+      if (now < host_eeprom_done) return;
+      EEPROM.write (EEAR, host_eedr);
+      host_eecr &= ~_BV(EEPE);
+      start = host_eeprom_done;
+    }
+    if (!(host_eecr & _BV(EERIE)) || !(SREG & 0x80) || !EE_READY_vect) return;
+
+    // The ISR runs with interrupts off like on the AVR
+    SREG &= ~0x80;
+    EE_READY_vect ();
+    SREG |= 0x80;
+    if (!(host_eecr & _BV(EEPE))) continue;
+    host_eeprom_done = start + HOST_EEPROM_WRITE_US;
+  }
+}
+
+volatile uint8_t *HostEECR (void)
+// Reading EEPE with interrupts on and the EEPROM ISR off is EERead() waiting for the byte being programmed.
+// The wait is skipped over rather than spun through and counted in host_wait_us
+{
+  unsigned long long now = host_run ();
+
+  if ((host_eecr & _BV(EEPE)) && !(host_eecr & _BV(EERIE)) && (SREG & 0x80) && host_eeprom_done > now) {
+    host_skipped_us += host_eeprom_done - now;
+    host_wait_us += host_eeprom_done - now;
+    host_run ();
+  }
+  return &host_eecr;
+}
+
+volatile uint8_t *HostEEDR (void)
+// EERE loads the byte at EEAR.  The AVR ignores it while a byte is being programmed
+{
+  if (host_eecr & _BV(EERE)) {
+    host_eecr &= ~_BV(EERE);
+    if (host_eecr & _BV(EEPE)) {
+      host_eeprom_bad_reads++;
+    } else {
+      host_eedr = EEPROM.read (EEAR);
+    }
+  }
+  return &host_eedr;
+}
+
+void toneAC (unsigned long frequency, uint8_t volume, unsigned long length, uint8_t background)
+{
+}
+
+void noToneAC (void)
+{
+}
+
+// Print
+size_t Print::printNumber (unsigned long n, int base)
+{
+  char buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+
+  if (base < 2) base = 10;
+  *str = 0;
+  do {
+    unsigned long m = n;
+    n /= base;
+    char c = m - base * n;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+
+  return write (str);
+}
+
+size_t Print::print (double n, int digits)
+{
+  char buf[40];
+
+  snprintf (buf, sizeof(buf), "%.*f", digits, n);
+  return write (buf);
+}
+
+// Serial.  The TX buffer holds HOST_TX_BUFFER - 1 bytes like the AVR core and empties at the baud rate
+// (10 bits per byte).  write() with the buffer full skips time until a byte has gone, as the real one
+// waits, and adds the wait to host_serial_blocked_us
+#define HOST_TX_BUFFER 64
+
+HardwareSerial Serial;
+unsigned long host_serial_tx_bytes;
+unsigned long long host_serial_blocked_us;
+static unsigned long host_baud = 9600;
+static unsigned int host_tx_level;
+static unsigned long long host_tx_last;
+static char host_rx[1024];
+static unsigned int host_rx_head, host_rx_tail;
+static unsigned char host_echo = 1;
+
+void HostSerialInput (const char *str)
+{
+  while (*str) {
+    host_rx[host_rx_head] = *str++;
+    host_rx_head = (host_rx_head + 1) % sizeof(host_rx);
+  }
+}
+
+void HostSerialEcho (unsigned char enable)
+{
+  host_echo = enable;
+}
+
+static void host_run_serial (unsigned long long now)
+{
+  unsigned long long n;
+
+  if (!host_tx_level) {
+    host_tx_last = now;
+    return;
+  }
+  n = (now - host_tx_last) * host_baud / 10000000ULL;
+  if (n >= host_tx_level) {
+    host_tx_level = 0;
+    host_tx_last = now;
+  } else if (n) {
+    host_tx_level -= n;
+    host_tx_last += n * 10000000ULL / host_baud;
+  }
+}
+
+void HardwareSerial::begin (unsigned long baud)
+{
+  host_baud = baud;
+}
+
+int HardwareSerial::available (void)
+{
+  return (host_rx_head + sizeof(host_rx) - host_rx_tail) % sizeof(host_rx);
+}
+
+int HardwareSerial::availableForWrite (void)
+{
+  host_run ();
+  return HOST_TX_BUFFER - 1 - host_tx_level;
+}
+
+int HardwareSerial::peek (void)
+{
+  return available () ? (unsigned char)host_rx[host_rx_tail] : -1;
+}
+
+int HardwareSerial::read (void)
+{
+  int c = peek ();
+
+  if (c >= 0) host_rx_tail = (host_rx_tail + 1) % sizeof(host_rx);
+  return c;
+}
+
+void HardwareSerial::flush (void)
+// Waits (skips time) until the TX buffer is empty
+{
+  host_run ();
+  while (host_tx_level) {
+    host_skipped_us += 10000000ULL / host_baud + 1;
+    host_run ();
+  }
+}
+
+size_t HardwareSerial::write (uint8_t c)
+{
+  unsigned long long wait = 10000000ULL / host_baud + 1;
+
+  host_run ();
+  while (host_tx_level >= HOST_TX_BUFFER - 1) {
+    host_skipped_us += wait;
+    host_serial_blocked_us += wait;
+    host_run ();
+  }
+  host_tx_level++;
+  host_serial_tx_bytes++;
+  if (host_echo) putchar (c);
+  return 1;
+}
+
+// Wire
+TwoWire Wire;
+uint8_t host_i2c_regs[256];
+void (*host_i2c_write_hook) (uint8_t reg, uint8_t value);
+unsigned char host_i2c_fail;
+static uint8_t host_i2c_addr, host_i2c_reg, host_i2c_first, host_i2c_nack;
+
+void TwoWire::begin (void)
+{
+  begins++;
+}
+
+void TwoWire::beginTransmission (uint8_t address)
+{
+  host_i2c_addr = address;
+  host_i2c_first = 1;
+  host_i2c_nack = 0;
+  if (address == SI5351_HOST_ADDRESS && host_i2c_fail) {
+    host_i2c_fail--;
+    host_i2c_nack = 1;
+  }
+  transactions++;
+  bytes++;
+}
+
+uint8_t TwoWire::endTransmission (void)
+{
+  return host_i2c_nack ? 2 : 0;
+}
+
+size_t TwoWire::write (uint8_t data)
+{
+  bytes++;
+  if (host_i2c_addr != SI5351_HOST_ADDRESS || host_i2c_nack) return 1;
+
+  if (host_i2c_first) {
+    host_i2c_reg = data;
+    host_i2c_first = 0;
+  } else {
+    host_i2c_regs[host_i2c_reg] = data;
+    if (host_i2c_write_hook) host_i2c_write_hook (host_i2c_reg, data);
+    host_i2c_reg++;
+  }
+  return 1;
+}
+
+uint8_t TwoWire::requestFrom (uint8_t address, uint8_t quantity)
+{
+  transactions++;
+  bytes += 1 + quantity;
+  return quantity;
+}
+
+int TwoWire::available (void)
+{
+  return 1;
+}
+
+int TwoWire::read (void)
+{
+  return host_i2c_regs[host_i2c_reg++];
+}
+
+// EEPROM
+EEPROMClass EEPROM;
+uint8_t host_eeprom[E2END + 1] = {0xFF};
+
+static void host_eeprom_init (void)
+{
+  static unsigned char done;
+
+  if (!done) memset (host_eeprom, 0xFF, sizeof(host_eeprom));
+  done = 1;
+}
+
+uint8_t EEPROMClass::read (int address)
+// Like eeprom_read_byte() in avr-libc this spins until the byte being programmed is done.  The spin is skipped
+// over rather than waited for and counted in host_eeprom_irqoff_us if interrupts are off
+{
+  unsigned long long now = host_now_us ();
+
+  host_eeprom_init ();
+  if ((host_eecr & _BV(EEPE)) && host_eeprom_done > now) {
+    host_skipped_us += host_eeprom_done - now;
+    if (!(SREG & 0x80)) host_eeprom_irqoff_us += host_eeprom_done - now;
+    host_run ();
+  }
+  if (host_eecr & _BV(EEPE)) host_eeprom_bad_reads++;
+  return host_eeprom[address & E2END];
+}
+
+void EEPROMClass::write (int address, uint8_t value)
+{
+  host_eeprom_init ();
+  host_eeprom[address & E2END] = value;
+  writes++;
+}
+
+// Display
+uint8_t pcd8544_buffer[LCDWIDTH * LCDHEIGHT / 8];
+unsigned long host_spi_bytes;
+unsigned long host_display_calls;
+
+void Adafruit_GFX::fillRect (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  int16_t i, j;
+
+  for (i = x; i < x + w; i++) {
+    for (j = y; j < y + h; j++) drawPixel (i, j, color);
+  }
+}
+
+void Adafruit_GFX::drawChar (int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+  uint8_t i, j, line;
+
+  for (i = 0; i < 6; i++) {
+    // Not the real font, just a repeatable 5x7 pattern per character
+    line = (i == 5 || c == ' ') ? 0 : (uint8_t)((c * 37 + i * 11) | 0x41) & 0x7F;
+    for (j = 0; j < 8; j++, line >>= 1) {
+      if (line & 1) {
+        if (size == 1) drawPixel (x + i, y + j, color);
+        else fillRect (x + i * size, y + j * size, size, size, color);
+      } else if (bg != color) {
+        if (size == 1) drawPixel (x + i, y + j, bg);
+        else fillRect (x + i * size, y + j * size, size, size, bg);
+      }
+    }
+  }
+}
+
+size_t Adafruit_GFX::write (uint8_t c)
+{
+  if (c == '\n') {
+    cursor_y += textsize * 8;
+    cursor_x = 0;
+  } else if (c != '\r') {
+    drawChar (cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+    cursor_x += textsize * 6;
+  }
+  return 1;
+}
+
+void Adafruit_PCD8544::begin (uint8_t contrast, uint8_t bias)
+{
+  command (PCD8544_FUNCTIONSET | PCD8544_EXTENDEDINSTRUCTION);
+  command (PCD8544_SETBIAS | bias);
+  setContrast (contrast);
+  command (PCD8544_FUNCTIONSET);
+  command (PCD8544_DISPLAYCONTROL | PCD8544_DISPLAYNORMAL);
+}
+
+void Adafruit_PCD8544::command (uint8_t c)
+{
+  host_spi_bytes++;
+}
+
+void Adafruit_PCD8544::data (uint8_t c)
+{
+  host_spi_bytes++;
+}
+
+void Adafruit_PCD8544::setContrast (uint8_t val)
+{
+  command (PCD8544_FUNCTIONSET | PCD8544_EXTENDEDINSTRUCTION);
+  command (PCD8544_SETVOP | (val & 0x7F));
+  command (PCD8544_FUNCTIONSET);
+}
+
+void Adafruit_PCD8544::clearDisplay (void)
+{
+  memset (pcd8544_buffer, 0, sizeof(pcd8544_buffer));
+  cursor_x = cursor_y = 0;
+}
+
+void Adafruit_PCD8544::display (void)
+{
+  uint8_t col, p;
+
+  host_display_calls++;
+  for (p = 0; p < LCDHEIGHT / 8; p++) {
+    command (PCD8544_SETYADDR | p);
+    command (PCD8544_SETXADDR);
+    for (col = 0; col < LCDWIDTH; col++) data (pcd8544_buffer[LCDWIDTH * p + col]);
+  }
+  command (PCD8544_SETYADDR);
+}
+
+void Adafruit_PCD8544::drawPixel (int16_t x, int16_t y, uint16_t color)
+{
+  if (x < 0 || x >= LCDWIDTH || y < 0 || y >= LCDHEIGHT) return;
+
+  if (color) pcd8544_buffer[x + (y / 8) * LCDWIDTH] |= _BV(y % 8);
+  else pcd8544_buffer[x + (y / 8) * LCDWIDTH] &= ~_BV(y % 8);
+}
+
+uint8_t Adafruit_PCD8544::getPixel (int8_t x, int8_t y)
+{
+  if (x < 0 || x >= LCDWIDTH || y < 0 || y >= LCDHEIGHT) return 0;
+
+  return (pcd8544_buffer[x + (y / 8) * LCDWIDTH] >> (y % 8)) & 0x1;
+}
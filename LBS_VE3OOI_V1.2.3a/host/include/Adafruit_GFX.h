@@ -0,0 +1,40 @@
+/*
+ * Host stand-in for Adafruit_GFX.  Text is drawn as simple 5x7 blocks (not the real font)
+ * so that pixel traffic and screen layout are similar to the real library.
+ */
+
+#ifndef _ADAFRUIT_GFX_H
+#define _ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print {
+  public:
+    Adafruit_GFX (int16_t w, int16_t h) : _width (w), _height (h), cursor_x (0), cursor_y (0),
+                                          textcolor (1), textbgcolor (1), textsize (1) {}
+
+    virtual void drawPixel (int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void fillRect (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen (uint16_t color) { fillRect (0, 0, _width, _height, color); }
+    void drawFastVLine (int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect (x, y, 1, h, color); }
+    void drawFastHLine (int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect (x, y, w, 1, color); }
+    void drawChar (int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+    void setCursor (int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+    void setTextColor (uint16_t c) { textcolor = textbgcolor = c; }
+    void setTextColor (uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+    void setTextSize (uint8_t s) { textsize = (s > 0) ? s : 1; }
+    int16_t width (void) const { return _width; }
+    int16_t height (void) const { return _height; }
+
+    size_t write (uint8_t c);
+    using Print::write;
+
+  protected:
+    int16_t _width, _height;
+    int16_t cursor_x, cursor_y;
+    uint16_t textcolor, textbgcolor;
+    uint8_t textsize;
+};
+
+#endif
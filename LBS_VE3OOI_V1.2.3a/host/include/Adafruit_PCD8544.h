@@ -0,0 +1,57 @@
+/*
+ * Host stand-in for the Adafruit PCD8544 (Nokia 5110) library v1.0.
+ * Like the real library the frame buffer is the global pcd8544_buffer[] and display()
+ * sends all of it.  Bytes that would go over the software SPI are counted.
+ */
+
+#ifndef _ADAFRUIT_PCD8544_H
+#define _ADAFRUIT_PCD8544_H
+
+#include "Adafruit_GFX.h"
+
+#define BLACK 1
+#define WHITE 0
+
+#define LCDWIDTH 84
+#define LCDHEIGHT 48
+
+#define PCD8544_POWERDOWN 0x04
+#define PCD8544_ENTRYMODE 0x02
+#define PCD8544_EXTENDEDINSTRUCTION 0x01
+
+#define PCD8544_DISPLAYBLANK 0x0
+#define PCD8544_DISPLAYNORMAL 0x4
+#define PCD8544_DISPLAYALLON 0x1
+#define PCD8544_DISPLAYINVERTED 0x5
+
+#define PCD8544_FUNCTIONSET 0x20
+#define PCD8544_DISPLAYCONTROL 0x08
+#define PCD8544_SETYADDR 0x40
+#define PCD8544_SETXADDR 0x80
+
+#define PCD8544_SETTEMP 0x04
+#define PCD8544_SETBIAS 0x10
+#define PCD8544_SETVOP 0x80
+
+extern uint8_t pcd8544_buffer[LCDWIDTH * LCDHEIGHT / 8];
+
+class Adafruit_PCD8544 : public Adafruit_GFX {
+  public:
+    Adafruit_PCD8544 (int8_t SCLK, int8_t DIN, int8_t DC, int8_t CS, int8_t RST) : Adafruit_GFX (LCDWIDTH, LCDHEIGHT) {}
+
+    void begin (uint8_t contrast = 40, uint8_t bias = 0x04);
+    void command (uint8_t c);
+    void data (uint8_t c);
+    void setContrast (uint8_t val);
+    void clearDisplay (void);
+    void display (void);
+
+    void drawPixel (int16_t x, int16_t y, uint16_t color);
+    uint8_t getPixel (int8_t x, int8_t y);
+};
+
+// Host statistics
+extern unsigned long host_spi_bytes;       // command and data bytes sent to the controller
+extern unsigned long host_display_calls;   // full frame display() calls
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Host stand-in for the Arduino core.  Only what the LBS sketch uses is provided.
+ * Pins, time, serial and the analog input are simulated in hal.cpp so the sketch
+ * and its libraries can be compiled and measured on Linux.
+ *
+ * Note that int is 32 bits and long is 64 bits on most hosts (16 and 32 bits on AVR)
+ * so overflow behaviour differs from the radio.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "binary.h"
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define NUM_HOST_PINS 22
+
+void pinMode (uint8_t pin, uint8_t mode);
+void digitalWrite (uint8_t pin, uint8_t val);
+int digitalRead (uint8_t pin);
+int analogRead (uint8_t pin);
+void analogWrite (uint8_t pin, int val);
+
+unsigned long millis (void);
+unsigned long micros (void);
+void delay (unsigned long ms);
+void delayMicroseconds (unsigned int us);
+
+inline bool isPrintable (int c) { return isprint (c); }
+
+// Arduino F() strings are plain strings on the host
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+class String {
+  public:
+    String (const char *str = "") { copy (str); }
+    String (const String &str) { copy (str.buf); }
+    String &operator = (const String &str) { copy (str.buf); return *this; }
+    String &operator = (const char *str) { copy (str); return *this; }
+    const char *c_str (void) const { return buf; }
+    unsigned int length (void) const { return strlen (buf); }
+    void toCharArray (char *dst, unsigned int len) const {
+      if (!len) return;
+      strncpy (dst, buf, len - 1);
+      dst[len - 1] = 0;
+    }
+  private:
+    void copy (const char *str) {
+      strncpy (buf, str ? str : "", sizeof(buf) - 1);
+      buf[sizeof(buf) - 1] = 0;
+    }
+    char buf[32];
+};
+
+class Print {
+  public:
+    virtual ~Print () {}
+    virtual size_t write (uint8_t c) = 0;
+    size_t write (const char *str) { return str ? write ((const uint8_t *)str, strlen (str)) : 0; }
+    size_t write (const char *buf, size_t len) { return write ((const uint8_t *)buf, len); }
+    virtual size_t write (const uint8_t *buf, size_t len) {
+      size_t n = 0;
+      while (len--) n += write (*buf++);
+      return n;
+    }
+
+    size_t print (const __FlashStringHelper *str) { return write ((const char *)str); }
+    size_t print (const String &str) { return write (str.c_str ()); }
+    size_t print (const char *str) { return write (str); }
+    size_t print (char c) { return write ((uint8_t)c); }
+    size_t print (unsigned char n, int base = DEC) { return printNumber (n, base); }
+    size_t print (int n, int base = DEC) { return print ((long)n, base); }
+    size_t print (unsigned int n, int base = DEC) { return printNumber (n, base); }
+    size_t print (long n, int base = DEC) {
+      if (base == DEC && n < 0) return write ('-') + printNumber (-(unsigned long)n, base);
+      return printNumber ((unsigned long)n, base);
+    }
+    size_t print (unsigned long n, int base = DEC) { return printNumber (n, base); }
+    size_t print (double n, int digits = 2);
+
+    size_t println (void) { return write ("\r\n"); }
+    template <typename T> size_t println (T v) { size_t n = print (v); return n + println (); }
+    template <typename T> size_t println (T v, int f) { size_t n = print (v, f); return n + println (); }
+
+  private:
+    size_t printNumber (unsigned long n, int base);
+};
+
+class HardwareSerial : public Print {
+  public:
+    void begin (unsigned long baud);
+    void end (void) {}
+    int available (void);
+    int availableForWrite (void);
+    int peek (void);
+    int read (void);
+    void flush (void);
+    size_t write (uint8_t c);
+    using Print::write;
+    operator bool () { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Host hooks used by the benchmark and tools
+void HostSerialInput (const char *str);          // Queue characters as if typed at the console
+void HostSerialEcho (unsigned char enable);      // Copy serial output to stdout (default on)
+extern unsigned long host_serial_tx_bytes;
+extern unsigned long long host_serial_blocked_us;   // Time Serial.write() waited for room in the TX buffer
+extern unsigned long long host_eeprom_irqoff_us;    // Time spent waiting for EEPE with interrupts off
+extern unsigned long long host_wait_us;             // Time in delay(), delayMicroseconds() and EERead() waiting for EEPE
+extern unsigned long host_eeprom_bad_reads;         // EERE or EEPROM.read() while EEPE was set
+extern unsigned char host_pins[NUM_HOST_PINS];   // digitalRead() values, 1 by default (buttons have pullups)
+extern int (*host_analog_source) (uint8_t pin);  // analogRead() source, NULL returns a little noise
+
+// Arduino sketch entry points
+void setup (void);
+void loop (void);
+
+#endif
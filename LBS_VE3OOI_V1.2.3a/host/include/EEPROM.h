@@ -0,0 +1,26 @@
+/*
+ * Host stand-in for the Arduino EEPROM library.  1 KB like the ATmega328P, erased to 0xFF.
+ */
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stdint.h>
+
+#define E2END 0x3FF
+
+class EEPROMClass {
+  public:
+    uint8_t read (int address);
+    void write (int address, uint8_t value);
+    void update (int address, uint8_t value) { if (read (address) != value) write (address, value); }
+    uint16_t length (void) { return E2END + 1; }
+
+    // Host statistics
+    unsigned long writes;
+};
+
+extern EEPROMClass EEPROM;
+extern uint8_t host_eeprom[E2END + 1];
+
+#endif
@@ -0,0 +1,8 @@
+/*
+ * Host stand-in for the Arduino SPI library.  The PCD8544 stand-in counts bytes itself.
+ */
+
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#endif
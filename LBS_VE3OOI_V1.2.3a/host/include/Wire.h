@@ -0,0 +1,48 @@
+/*
+ * Host stand-in for the Arduino Wire (I2C) library.
+ * Writes to SI5351_ADDRESS go to a 256 byte register file with auto increment so
+ * the driver can read back what it wrote.  All bus traffic is counted.
+ */
+
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire {
+  public:
+    void begin (void);
+    void setClock (uint32_t clock) { this->clock = clock; }
+    void beginTransmission (uint8_t address);
+    void beginTransmission (int address) { beginTransmission ((uint8_t)address); }
+    uint8_t endTransmission (void);
+    uint8_t requestFrom (uint8_t address, uint8_t quantity);
+    uint8_t requestFrom (int address, uint8_t quantity) { return requestFrom ((uint8_t)address, quantity); }
+    uint8_t requestFrom (int address, int quantity) { return requestFrom ((uint8_t)address, (uint8_t)quantity); }
+    size_t write (uint8_t data);
+    int available (void);
+    int read (void);
+
+    // Host statistics
+    unsigned long begins;         // begin() calls
+    uint32_t clock;               // setClock() value
+    unsigned long transactions;   // start/stop transactions (writes and reads)
+    unsigned long bytes;          // bytes on the bus including the address byte
+};
+
+extern TwoWire Wire;
+
+// Register file of the device at the Si5351 address
+extern uint8_t host_i2c_regs[256];
+
+// Number of the next write transactions to the Si5351 address that are not acknowledged.  Their bytes do not
+// reach host_i2c_regs and endTransmission() returns 2 (address NACK) as the AVR Wire library does
+extern unsigned char host_i2c_fail;
+
+// Called for every register byte written to the Si5351 address (after host_i2c_regs is updated)
+extern void (*host_i2c_write_hook) (uint8_t reg, uint8_t value);
+
+#endif
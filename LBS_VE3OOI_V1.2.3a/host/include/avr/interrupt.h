@@ -0,0 +1,20 @@
+/*
+ * Host stand-in for avr/interrupt.h.  An ISR is an ordinary function that the host code calls
+ * to simulate the interrupt.
+ */
+
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) extern "C" void vector (void)
+
+#define sei() (SREG |= 0x80)
+#define cli() (SREG &= (uint8_t)~0x80)
+
+extern "C" void PCINT2_vect (void);
+extern "C" void ADC_vect (void);
+extern "C" void EE_READY_vect (void);
+
+#endif
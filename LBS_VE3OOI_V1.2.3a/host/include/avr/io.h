@@ -0,0 +1,58 @@
+/*
+ * Host stand-in for avr/io.h.  ATmega328P registers used by the sketch are plain variables
+ * defined in hal.cpp so the code that touches them compiles and can be inspected.
+ */
+
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+// Pin change interrupts
+extern volatile uint8_t PCICR;
+extern volatile uint8_t PCMSK2;
+#define PCIE2    2
+#define PCINT18  2
+#define PCINT19  3
+
+// Port input registers read the simulated pins in host_pins[] (D0-D7 PIND, D8-D13 PINB, A0-A5 PINC)
+uint8_t HostReadPort (uint8_t port);
+#define PIND HostReadPort (0)
+#define PINB HostReadPort (1)
+#define PINC HostReadPort (2)
+
+// ADC.  hal.cpp runs free running conversions in the background when ADATE and ADIE are set
+extern volatile uint8_t ADMUX;
+extern volatile uint8_t ADCSRA;
+extern volatile uint8_t ADCSRB;
+extern volatile uint16_t ADC;
+#define REFS1  7
+#define REFS0  6
+#define ADLAR  5
+#define ADEN   7
+#define ADSC   6
+#define ADATE  5
+#define ADIF   4
+#define ADIE   3
+#define ADPS2  2
+#define ADPS1  1
+#define ADPS0  0
+
+// EEPROM.  hal.cpp programs EEDR into EEAR about 3.4 ms after EEPE is set and calls EE_READY_vect while EERIE is set.
+// EECR and EEDR go through functions so that polling EEPE lets time pass and setting EERE loads EEDR
+volatile uint8_t *HostEECR (void);
+volatile uint8_t *HostEEDR (void);
+#define EECR (*HostEECR ())
+#define EEDR (*HostEEDR ())
+extern volatile uint16_t EEAR;
+#define EERIE  3
+#define EEMPE  2
+#define EEPE   1
+#define EERE   0
+
+// Status register.  Only the interrupt flag is simulated
+extern volatile uint8_t SREG;
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Host stand-in for avr/pgmspace.h.  Flash and RAM are the same address space on the host.
+ */
+
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  ((uint16_t)*(addr))     // Tables are int sized on the host so read them as declared
+#define pgm_read_dword(addr) ((uint32_t)*(addr))     // Same for long tables (64 bit on the host)
+#define pgm_read_ptr(addr)   (*(void * const *)(addr))
+
+#define strlen_P  strlen
+#define strcpy_P  strcpy
+#define strncpy_P strncpy
+#define memcpy_P  memcpy
+
+#endif
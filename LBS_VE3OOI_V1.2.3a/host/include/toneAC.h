@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for the toneAC library.
+ */
+
+#ifndef toneAC_h
+#define toneAC_h
+
+#include <stdint.h>
+
+void toneAC (unsigned long frequency = 0, uint8_t volume = 10, unsigned long length = 0, uint8_t background = false);
+void noToneAC (void);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Host stand-in for util/atomic.h.  The block saves SREG, clears the interrupt flag and restores
+ * SREG on exit like avr-libc does.  The host has no real interrupts so this only keeps the code
+ * path the same.
+ */
+
+#ifndef _UTIL_ATOMIC_H_
+#define _UTIL_ATOMIC_H_
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+
+static inline uint8_t __host_atomic_begin (void) { uint8_t s = SREG; cli (); return s; }
+
+#define ATOMIC_BLOCK(type) \
+  for (uint8_t __sreg_save = __host_atomic_begin (), __todo = 1; __todo; SREG = __sreg_save, __todo = 0)
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Register level model of the Si5351A.  See si5351_model.h
+ */
+
+#include <string.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "VE3OOI_Si5351_v1.3.h"
+#include "si5351_model.h"
+
+Si5351_model_stats si5351model;
+
+static unsigned char regs[256];
+static long double crystal;
+
+static void ModelHook (uint8_t reg, uint8_t value)
+{
+  Si5351ModelWrite (reg, value);
+}
+
+void Si5351ModelReset (long double xtal)
+// Power on state: all outputs powered down and disabled, multisynths zero
+{
+  memset (regs, 0, sizeof(regs));
+  memset (&si5351model, 0, sizeof(si5351model));
+  regs[SIREG_3_OUTPUT_ENABLE_CTL] = 0xFF;
+  regs[SIREG_16_CLK0_CTL] = regs[SIREG_17_CLK1_CTL] = regs[SIREG_18_CLK2_CTL] = SI_CLK_OFF;
+  regs[SIREG_183_CRY_LOAD_CAP] = 0xD2;      // 10 pF
+  crystal = xtal;
+}
+
+void Si5351ModelAttach (void)
+{
+  host_i2c_write_hook = ModelHook;
+}
+
+void Si5351ModelDetach (void)
+{
+  host_i2c_write_hook = NULL;
+}
+
+void Si5351ModelWrite (unsigned char reg, unsigned char value)
+// PLL reset is self clearing so it is counted and not stored
+{
+  si5351model.writes++;
+
+  if (reg == SIREG_177_PLL_RESET) {
+    if (value & 0x20) si5351model.resetsA++;
+    if (value & 0x80) si5351model.resetsB++;
+    return;
+  }
+  regs[reg] = value;
+}
+
+unsigned char Si5351ModelRegister (unsigned char reg)
+{
+  return regs[reg];
+}
+
+static long double MultisynthRatio (unsigned char base)
+// a + b/c from the P1, P2 and P3 stored at base.  a + b/c = (P1 + 512)/128 + P2/(128 * P3)
+{
+  unsigned char *r = &regs[base];
+  unsigned long P1, P2, P3;
+
+  P1 = ((unsigned long)(r[2] & 0x03) << 16) | ((unsigned long)r[3] << 8) | r[4];
+  P2 = ((unsigned long)(r[5] & 0x0F) << 16) | ((unsigned long)r[6] << 8) | r[7];
+  P3 = ((unsigned long)(r[5] & 0xF0) << 12) | ((unsigned long)r[0] << 8) | r[1];
+  if (!P3) return 0;
+
+  return ((long double)(P1 + 512) * P3 + P2) / (128.0L * P3);
+}
+
+long double Si5351ModelPLL (char pll)
+{
+  return crystal * MultisynthRatio (pll == SI_PLL_B ? SIREG_34_MSNB_1 : SIREG_26_MSNA_1);
+}
+
+void Si5351ModelClock (unsigned char clk, Si5351_model_clk *out)
+{
+  unsigned char ctl = regs[SIREG_16_CLK0_CTL + clk];
+  unsigned char *ms = &regs[SIREG_42_MSYN0_1 + clk * SI_MSREGS];
+  long double ratio;
+
+  memset (out, 0, sizeof(*out));
+  out->integer = (ctl & SI_CLK_MS_INT) ? 1 : 0;
+  out->invert = (ctl & SI_CLK_INVERT) ? 1 : 0;
+  out->drive = 2 + 2 * (ctl & 0x3);
+  out->divby4 = ((ms[2] & 0x0C) == 0x0C) ? 1 : 0;
+  out->rdiv = 1 << ((ms[2] >> 4) & 0x7);
+
+  if (ctl & SI_CLK_OFF) {
+    out->status = SI_MODEL_POWERED_DOWN;
+    return;
+  }
+
+  switch (ctl & SI_CLK_SRC_MS) {
+    case 0x00:
+      // Crystal pass through. R_DIV still applies
+      out->pll = SI_XTAL;
+      out->vco = crystal;
+      out->msdiv = 1;
+      break;
+
+    case SI_CLK_SRC_MS:
+      out->pll = (ctl & SI_CLK_SRC_PLLB) ? SI_PLL_B : SI_PLL_A;
+      out->vco = Si5351ModelPLL (out->pll);
+      if (out->vco < SI_MIN_PLL_FREQ || out->vco > SI_MAX_PLL_FREQ) {
+        out->status = SI_MODEL_BAD_VCO;
+        return;
+      }
+      ratio = out->divby4 ? 4 : MultisynthRatio (SIREG_42_MSYN0_1 + clk * SI_MSREGS);
+      if (!(ratio == 4 && out->divby4) && ratio != 6 && (ratio < 8 || ratio > 2048)) {
+        out->status = SI_MODEL_BAD_DIVIDER;
+        return;
+      }
+      out->msdiv = ratio;
+      break;
+
+    default:
+      // CLKIN or another multisynth.  The Si5351A in the radio has neither
+      out->status = SI_MODEL_BAD_SOURCE;
+      return;
+  }
+
+  if (regs[SIREG_3_OUTPUT_ENABLE_CTL] & (1 << clk)) {
+    out->status = SI_MODEL_DISABLED;
+    return;
+  }
+
+  out->freq = out->vco / out->msdiv / out->rdiv;
+}
+
+long double Si5351ModelFrequency (unsigned char clk)
+{
+  Si5351_model_clk c;
+
+  Si5351ModelClock (clk, &c);
+  return c.freq;
+}
+
+unsigned char Si5351ModelLoadCap (void)
+// Returns the crystal load capacitance in pF.  Bits 7:6 of register 183 (0 is reserved)
+{
+  return 4 + 2 * (regs[SIREG_183_CRY_LOAD_CAP] >> 6);
+}
+
+const char *Si5351ModelStatus (unsigned char status)
+{
+  switch (status) {
+    case SI_MODEL_OK:           return "ok";
+    case SI_MODEL_POWERED_DOWN: return "powered down";
+    case SI_MODEL_DISABLED:     return "output disabled";
+    case SI_MODEL_BAD_SOURCE:   return "bad clock source";
+    case SI_MODEL_BAD_VCO:      return "PLL out of range";
+    case SI_MODEL_BAD_DIVIDER:  return "bad output divider";
+  }
+  return "?";
+}
@@ -0,0 +1,53 @@
+/*
+ * Register level model of the Si5351A (3 output, crystal only) for the host build.
+ * The model sees every register byte the driver writes over I2C and decodes the PLL feedback
+ * multisynths (MSNA/MSNB), the output multisynths (MS0-MS2), R_DIV, DIVBY4, the clock control
+ * source bits, the output enable register and the crystal load capacitance (AN619).
+ *
+ * Frequencies are computed from the decoded P1, P2 and P3 in long double so the result is what
+ * the chip would generate for a crystal of the given frequency, independent of the driver math.
+ */
+
+#ifndef _SI5351_MODEL_H_
+#define _SI5351_MODEL_H_
+
+#define SI_MODEL_OK             0
+#define SI_MODEL_POWERED_DOWN   1    // CLK_PDN set in the clock control register
+#define SI_MODEL_DISABLED       2    // Output disabled in register 3
+#define SI_MODEL_BAD_SOURCE     3    // Clock source is not the multisynth or the crystal
+#define SI_MODEL_BAD_VCO        4    // PLL outside 600-900 MHz
+#define SI_MODEL_BAD_DIVIDER    5    // Output multisynth divider outside 8-2048 (or 4 with DIVBY4)
+
+typedef struct {
+  unsigned char status;          // SI_MODEL_xxx
+  char pll;                      // 'A', 'B' or 'X' for crystal pass through
+  unsigned char integer;         // MSx_INT bit
+  unsigned char divby4;
+  unsigned char rdiv;            // Output divider 1-128
+  unsigned char invert;
+  unsigned char drive;           // mA
+  long double vco;               // PLL frequency in Hz
+  long double msdiv;             // Output multisynth divide ratio
+  long double freq;              // Output frequency in Hz (0 if the clock is not running)
+} Si5351_model_clk;
+
+typedef struct {
+  unsigned long writes;          // Register bytes written
+  unsigned long resetsA;         // PLL A resets (register 177 bit 5)
+  unsigned long resetsB;         // PLL B resets (register 177 bit 7)
+} Si5351_model_stats;
+
+void Si5351ModelReset (long double xtal);
+void Si5351ModelAttach (void);
+void Si5351ModelDetach (void);
+void Si5351ModelWrite (unsigned char reg, unsigned char value);
+unsigned char Si5351ModelRegister (unsigned char reg);
+long double Si5351ModelPLL (char pll);
+void Si5351ModelClock (unsigned char clk, Si5351_model_clk *out);
+long double Si5351ModelFrequency (unsigned char clk);
+unsigned char Si5351ModelLoadCap (void);
+const char *Si5351ModelStatus (unsigned char status);
+
+extern Si5351_model_stats si5351model;
+
+#endif // _SI5351_MODEL_H_
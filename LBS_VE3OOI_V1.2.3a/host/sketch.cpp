@@ -0,0 +1,7 @@
+/*
+ * Compiles the sketch as an ordinary C++ file.  The Arduino IDE adds the Arduino.h include
+ * and generates prototypes; here the prototypes come from LBS_VE3OOI_V1.3.h.
+ */
+
+#include "Arduino.h"
+#include "../LBS_VE3OOI_V1.2.3a.ino"
@@ -0,0 +1,267 @@
+/*
+ * Frequency accuracy sweep.  Calls SetFrequency() for many target frequencies and checks what
+ * the Si5351 model says the chip would output for the registers that were written.
+ *
+ *   ./sweep [-n count] [-s start] [-e end] [-t step] [-c ppb] [-k clk] [-r seed] [-F] [-w worst]
+ *
+ *   -n  number of targets (default 1000000)
+ *   -s  -e  frequency range in Hz (default 8 kHz to 160 MHz)
+ *   -t  step in Hz.  Without -t targets are random in the range, with -t they walk from start to end
+ *   -c  crystal correction in ppb.  The model crystal runs at 25 MHz * (1 + ppb/1e9) so a correct
+ *       driver still hits the target exactly
+ *   -k  clock output (0-2)
+ *   -r  random seed
+ *   -F  disable fast tune
+ *   -w  number of worst cases to list (default 10)
+ *
+ * After the sweep a few fixed retune sequences, some with a failed I2C write, are checked against the model.
+ * The exit status is 1 if any of them is off by 1 Hz or more.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "VE3OOI_Si5351_v1.3.h"
+#include "si5351_model.h"
+
+extern Si5351_def multisynth;
+
+#define MAX_WORST   50
+#define ERR_BUCKETS 7
+
+typedef struct {
+  unsigned long target;
+  long double freq;
+  long double err;
+  long double vco;
+  long double msdiv;
+  unsigned char rdiv;
+} worst_def;
+
+static const long double bucket_limit[ERR_BUCKETS - 1] = {1e-9L, 1e-6L, 1e-3L, 1e-2L, 1e-1L, 1.0L};
+static const char *bucket_name[ERR_BUCKETS] = {"exact", "< 1 uHz", "< 1 mHz", "< 10 mHz", "< 100 mHz", "< 1 Hz", ">= 1 Hz"};
+
+static double now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned long xorshift (unsigned long *state)
+{
+  unsigned long x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+static int retune_check (unsigned char clk, unsigned long pllfreq, unsigned long first, unsigned long second)
+// Sets up first (with pllfreq, 0 for auto) then retunes to second with SetFrequency().  Returns 1 if the output is off
+{
+  Si5351_model_clk out;
+  long double err;
+
+  ResetSi5351 (SI_CRY_LOAD_8PF);
+  SetupFrequency (clk, SI_PLL_A, pllfreq, first, 0, SI_CLK_8MA);
+  SetFrequency (clk, SI_PLL_A, second, SI_CLK_8MA);
+  Si5351ModelClock (clk, &out);
+  err = out.status == SI_MODEL_OK ? out.freq - second : second;
+
+  printf ("  PLL %9lu, %9lu then %9lu Hz: %18.6Lf Hz %s\n", pllfreq, first, second, out.freq,
+          fabsl (err) < 1.0L ? "ok" : "FAILED");
+  return fabsl (err) >= 1.0L;
+}
+
+static int drive_phase_check (unsigned char clk, unsigned int phase, unsigned char drive, unsigned long first, unsigned long second)
+// Sets up first at 8 mA with phase (degrees) then retunes to second at drive mA with no phase.  Returns 1 if the
+// output is off, the drive was not applied or the phase register was not cleared
+{
+  Si5351_model_clk out;
+  long double err;
+  unsigned char phasereg;
+
+  ResetSi5351 (SI_CRY_LOAD_8PF);
+  SetupFrequency (clk, SI_PLL_A, SI_AUTO_PLL_FREQ, first, phase, 8);
+  SetFrequency (clk, SI_PLL_A, second, drive);
+  Si5351ModelClock (clk, &out);
+  phasereg = Si5351ModelRegister (SIREG_165_CLK0_PHASE_OFFSET + clk);
+  err = out.status == SI_MODEL_OK ? out.freq - second : second;
+
+  printf ("  %9lu at 8 mA %2u deg then %9lu at %u mA: %18.6Lf Hz %u mA phase %3u %s\n", first, phase, second, drive,
+          out.freq, out.drive, phasereg, fabsl (err) < 1.0L && out.drive == drive && !phasereg ? "ok" : "FAILED");
+  return fabsl (err) >= 1.0L || out.drive != drive || phasereg;
+}
+
+static int i2c_error_check (unsigned char clk, unsigned long first, unsigned long second)
+// Sets up first, retunes to second with the first I2C transaction not acknowledged, then asks for second again.
+// The repeat must reach the chip even though the driver already thinks it wrote those registers.  Returns 1 if the output is off
+{
+  Si5351_model_clk out;
+  long double err;
+
+  ResetSi5351 (SI_CRY_LOAD_8PF);
+  SetFrequency (clk, SI_PLL_A, first, SI_CLK_8MA);
+  host_i2c_fail = 1;
+  SetFrequency (clk, SI_PLL_A, second, SI_CLK_8MA);
+  host_i2c_fail = 0;
+  SetFrequency (clk, SI_PLL_A, second, SI_CLK_8MA);
+  Si5351ModelClock (clk, &out);
+  err = out.status == SI_MODEL_OK ? out.freq - second : second;
+
+  printf ("  %9lu then %9lu Hz, first write lost, repeated: %18.6Lf Hz %s\n", first, second, out.freq,
+          fabsl (err) < 1.0L ? "ok" : "FAILED");
+  return fabsl (err) >= 1.0L;
+}
+
+static void usage (void)
+{
+  fprintf (stderr, "usage: sweep [-n count] [-s start] [-e end] [-t step] [-c ppb] [-k clk] [-r seed] [-F] [-w worst]\n");
+  exit (1);
+}
+
+int main (int argc, char **argv)
+{
+  unsigned long count = 1000000, start = SI_MIN_OUT_FREQ, end = SI_MAX_OUT_FREQ, step = 0, seed = 1;
+  unsigned long target, n, i, failed[8], buckets[ERR_BUCKETS], i2c;
+  unsigned char clk = SI_CLK0, fast = 1, nworst = 10, b;
+  long correction = 0;
+  long double err, aerr, sum = 0, sumsq = 0, relmax = 0;
+  double t, solve = 0;
+  worst_def worst[MAX_WORST];
+  Si5351_model_clk out;
+  int c;
+
+  for (c = 1; c < argc; c++) {
+    if (argv[c][0] != '-' || !argv[c][1]) usage ();
+    if (argv[c][1] == 'F') {
+      fast = 0;
+      continue;
+    }
+    if (c + 1 >= argc) usage ();
+    switch (argv[c][1]) {
+      case 'n': count = strtoul (argv[++c], NULL, 10); break;
+      case 's': start = strtoul (argv[++c], NULL, 10); break;
+      case 'e': end = strtoul (argv[++c], NULL, 10); break;
+      case 't': step = strtoul (argv[++c], NULL, 10); break;
+      case 'c': correction = strtol (argv[++c], NULL, 10); break;
+      case 'k': clk = atoi (argv[++c]) % 3; break;
+      case 'r': seed = strtoul (argv[++c], NULL, 10); break;
+      case 'w': nworst = atoi (argv[++c]); break;
+      default: usage ();
+    }
+  }
+  if (nworst > MAX_WORST) nworst = MAX_WORST;
+  if (start < SI_MIN_OUT_FREQ) start = SI_MIN_OUT_FREQ;
+  if (end > SI_MAX_OUT_FREQ) end = SI_MAX_OUT_FREQ;
+  if (end < start || !count) usage ();
+  if (!seed) seed = 1;
+
+  HostSerialEcho (0);
+  Si5351ModelReset (SI_CRY_FREQ_25MHZ * (1.0L + correction / 1e9L));
+  Si5351ModelAttach ();
+
+  multisynth.correction = correction;
+  ResetSi5351 (SI_CRY_LOAD_8PF);
+  Si5351FastTune (fast);
+
+  memset (failed, 0, sizeof(failed));
+  memset (buckets, 0, sizeof(buckets));
+  memset (worst, 0, sizeof(worst));
+  i2c = Wire.bytes;
+
+  for (n = 0, target = start; n < count; n++) {
+    if (step) {
+      if (n && (target += step) > end) target = start;
+    } else {
+      target = start + xorshift (&seed) % (end - start + 1);
+    }
+
+    t = now_ns ();
+    SetFrequency (clk, SI_PLL_A, target, SI_CLK_8MA);
+    solve += now_ns () - t;
+
+    Si5351ModelClock (clk, &out);
+    if (out.status != SI_MODEL_OK) {
+      failed[out.status]++;
+      continue;
+    }
+
+    err = out.freq - target;
+    aerr = fabsl (err);
+    sum += aerr;
+    sumsq += err * err;
+    if (aerr / target > relmax) relmax = aerr / target;
+
+    for (b = 0; b < ERR_BUCKETS - 1 && aerr >= bucket_limit[b]; b++);
+    buckets[b]++;
+
+    // Keep the worst cases sorted, largest first
+    if (nworst && aerr > fabsl (worst[nworst - 1].err)) {
+      for (i = nworst - 1; i > 0 && aerr > fabsl (worst[i - 1].err); i--) worst[i] = worst[i - 1];
+      worst[i].target = target;
+      worst[i].freq = out.freq;
+      worst[i].err = err;
+      worst[i].vco = out.vco;
+      worst[i].msdiv = out.msdiv;
+      worst[i].rdiv = out.rdiv;
+    }
+  }
+  i2c = Wire.bytes - i2c;
+
+  printf ("Sweep of %lu targets %s %lu to %lu Hz", count, step ? "stepping" : "random", start, end);
+  if (step) printf (" by %lu Hz", step);
+  printf (", CLK%d, correction %ld ppb, fast tune %s, load cap %d pF\n\n", clk, correction, fast ? "on" : "off", Si5351ModelLoadCap ());
+
+  printf ("Time per solve      %10.1f ns\n", solve / count);
+  printf ("I2C bytes per solve %10.1f\n", (double)i2c / count);
+  printf ("PLL resets          %10lu A, %lu B\n", si5351model.resetsA, si5351model.resetsB);
+  for (b = SI_MODEL_POWERED_DOWN; b <= SI_MODEL_BAD_DIVIDER; b++) {
+    if (failed[b]) printf ("Failed: %-12s %10lu\n", Si5351ModelStatus (b), failed[b]);
+  }
+
+  n = 0;
+  for (b = 0; b < ERR_BUCKETS; b++) n += buckets[b];
+  if (!n) return 1;
+
+  printf ("\nError distribution (|output - target|)\n");
+  for (b = 0; b < ERR_BUCKETS; b++) {
+    printf ("  %-10s %10lu  %6.2f%%\n", bucket_name[b], buckets[b], 100.0 * buckets[b] / n);
+  }
+  printf ("  mean %.3Le Hz, rms %.3Le Hz, max %.3Le Hz, max relative %.3Le\n",
+          sum / n, sqrtl (sumsq / n), fabsl (worst[0].err), relmax);
+
+  if (nworst && worst[0].target) {
+    printf ("\nWorst cases\n");
+    printf ("  %12s %22s %14s %18s %16s %4s\n", "target Hz", "output Hz", "error Hz", "PLL Hz", "MS divider", "R");
+    for (b = 0; b < nworst && worst[b].target; b++) {
+      printf ("  %12lu %22.9Lf %14.6Le %18.3Lf %16.9Lf %4d\n", worst[b].target, worst[b].freq, worst[b].err,
+              worst[b].vco, worst[b].msdiv, worst[b].rdiv);
+    }
+  }
+
+  // Retunes that must not take the fast path or must take it correctly.  A fractional output divider
+  // (explicit PLL frequency) used to be fast tuned as if it were a whole number
+  printf ("\nRetune checks\n");
+  c = retune_check (clk, 800000000UL, 7100000, 7100100);
+  c |= retune_check (clk, SI_AUTO_PLL_FREQ, 7100000, 7100100);
+  c |= retune_check (clk, 750000000UL, 7500000, 7500500);
+
+  // The fast path only moves the PLL.  A new drive must still be applied and a phase offset must take the full path
+  printf ("\nDrive and phase checks\n");
+  c |= drive_phase_check (clk, 0, 2, 7100000, 7100100);
+  c |= drive_phase_check (clk, 45, 8, 7100000, 7100100);
+
+  // A write the Si5351 did not acknowledge must not leave the shadow registers claiming it holds the new value
+  printf ("\nI2C error checks\n");
+  c |= i2c_error_check (clk, 7100000, 7100500);
+  c |= i2c_error_check (clk, 7100000, 14200000);
+
+  return c;
+}
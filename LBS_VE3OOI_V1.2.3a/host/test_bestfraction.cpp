@@ -0,0 +1,111 @@
+/*
+ * Checks that BestFraction() is never worse than FareyFraction().  Both approximate num/den with a
+ * denominator of at most FAREY_N.  The error |x/y - num/den| of each result is compared exactly as
+ * |x*den - num*y| / (y*den) with 128 bit cross products so no rounding gets in the way.
+ *
+ *   ./test_bestfraction [-n count] [-r seed]
+ *
+ *   -n  random fractions on top of the fixed sweeps (default 200000)
+ *   -r  random seed
+ *
+ * Exits 1 if BestFraction() is worse on any point or returns a denominator over FAREY_N.
+ */
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "VE3OOI_Si5351_v1.3.h"
+
+typedef unsigned __int128 u128;
+
+static unsigned long points, better, same, worse, farey_over;
+
+static unsigned long xorshift (unsigned long *state)
+{
+  unsigned long x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+static u128 error_num (unsigned long x, unsigned long y, unsigned long num, unsigned long den)
+// |x*den - num*y|.  The error is this divided by y*den
+{
+  u128 a = (u128)x * den, b = (u128)num * y;
+
+  return a > b ? a - b : b - a;
+}
+
+static void check (unsigned long num, unsigned long den)
+{
+  unsigned long bx, by, fx, fy;
+  u128 be, fe;
+
+  BestFraction (num, den, &bx, &by);
+  FareyFraction ((double)num / den, &fx, &fy);
+  points++;
+
+  if (!by || by > FAREY_N) {
+    printf ("FAIL %lu/%lu: BestFraction gave %lu/%lu, denominator out of range\n", num, den, bx, by);
+    worse++;
+    return;
+  }
+  // FareyFraction() can step one past FAREY_N.  Such a result cannot be used so it is not compared
+  if (!fy || fy > FAREY_N) {
+    farey_over++;
+    return;
+  }
+
+  // Compare be/(by*den) with fe/(fy*den), i.e. be*fy with fe*by.  Both fit in 128 bits
+  be = error_num (bx, by, num, den) * fy;
+  fe = error_num (fx, fy, num, den) * by;
+  if (be < fe) {
+    better++;
+  } else if (be == fe) {
+    same++;
+  } else {
+    worse++;
+    if (worse <= 10) printf ("FAIL %lu/%lu: BestFraction %lu/%lu, FareyFraction %lu/%lu\n", num, den, bx, by, fx, fy);
+  }
+}
+
+int main (int argc, char **argv)
+{
+  // Denominators the driver divides by: output frequencies (Hz), the crystal and PLL frequencies.
+  // 1000003 is prime so every numerator gives a different reduced fraction
+  static const unsigned long dens[] = {1000003, 1048576, 3500000, 7100000, 14074000, 25000000, 28000000,
+                                       50000000, 99999989, 150000000};
+  unsigned long count = 200000, seed = 1, den, num, step, n;
+  unsigned char d;
+  int c;
+
+  for (c = 1; c + 1 < argc; c += 2) {
+    if (argv[c][0] != '-') break;
+    switch (argv[c][1]) {
+      case 'n': count = strtoul (argv[c + 1], NULL, 10); break;
+      case 'r': seed = strtoul (argv[c + 1], NULL, 10); break;
+    }
+  }
+  if (!seed) seed = 1;
+
+  // Dense sweep of numerators below each denominator, including the ends
+  for (d = 0; d < sizeof(dens) / sizeof(dens[0]); d++) {
+    den = dens[d];
+    step = den / 20000 ? den / 20000 : 1;
+    for (num = 0; num < den; num += step) check (num, den);
+    check (1, den);
+    check (den - 1, den);
+  }
+
+  // Random fractions over the whole 32 bit range the driver uses
+  for (n = 0; n < count; n++) {
+    den = 2 + xorshift (&seed) % 0xFFFFFFFEUL;
+    check (xorshift (&seed) % den, den);
+  }
+
+  printf ("%lu fractions: BestFraction better %lu, same %lu, worse %lu (%lu FareyFraction results over FAREY_N skipped)\n",
+          points, better, same, worse, farey_over);
+  return worse ? 1 : 0;
+}